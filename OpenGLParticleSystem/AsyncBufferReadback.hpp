@@ -0,0 +1,224 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <iostream>
+#include <glad/glad.h>
+
+
+/// <summary>
+/// Reads a range of a GPU buffer back to the CPU without stalling.
+/// Request() copies the range into a persistently mapped staging buffer on the GPU and places a fence after the copy.
+/// The readback can then be polled with IsReady() in later frames, and its data read straight from the mapping once it's ready.
+/// A readback can be reused for another request once it's ready, or keep a few of them around for a request every frame
+/// </summary>
+class AsyncBufferReadback
+{
+
+private:
+
+    /// <summary>
+    /// An identifier used by the API
+    /// </summary>
+    std::uint32_t _bufferId = 0;
+
+    /// <summary>
+    /// The size of the staging buffer in bytes
+    /// </summary>
+    std::size_t _capacityInBytes = 0;
+
+    /// <summary>
+    /// The persistent mapping of the staging buffer
+    /// </summary>
+    const std::byte* _mappedBuffer = nullptr;
+
+    /// <summary>
+    /// Signaled once the requested copy is done. Null if there is no request in flight
+    /// </summary>
+    GLsync _fence = nullptr;
+
+    /// <summary>
+    /// The size of the last request in bytes
+    /// </summary>
+    std::size_t _sizeInBytes = 0;
+
+    /// <summary>
+    /// Was a request made, and did its data arrive
+    /// </summary>
+    bool _requested = false;
+    bool _ready = false;
+
+
+public:
+
+    AsyncBufferReadback(const std::size_t capacityInBytes) :
+        _capacityInBytes(capacityInBytes)
+    {
+        constexpr GLbitfield flags = GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+        glGenBuffers(1, &_bufferId);
+
+        glBindBuffer(GL_COPY_WRITE_BUFFER, _bufferId);
+
+        glBufferStorage(GL_COPY_WRITE_BUFFER, capacityInBytes, nullptr, flags);
+
+        _mappedBuffer = static_cast<const std::byte*>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, capacityInBytes, flags));
+    };
+
+
+    AsyncBufferReadback(AsyncBufferReadback&& other) noexcept :
+        _bufferId(other._bufferId),
+        _capacityInBytes(other._capacityInBytes),
+        _mappedBuffer(other._mappedBuffer),
+        _fence(other._fence),
+        _sizeInBytes(other._sizeInBytes),
+        _requested(other._requested),
+        _ready(other._ready)
+    {
+        other._bufferId = 0;
+        other._mappedBuffer = nullptr;
+        other._fence = nullptr;
+    };
+
+    AsyncBufferReadback(const AsyncBufferReadback&) = delete;
+
+
+    ~AsyncBufferReadback()
+    {
+        if(_fence != nullptr)
+            glDeleteSync(_fence);
+
+        if(_bufferId != 0)
+        {
+            glBindBuffer(GL_COPY_WRITE_BUFFER, _bufferId);
+            glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+
+            glDeleteBuffers(1, &_bufferId);
+        };
+    };
+
+
+public:
+
+    /// <summary>
+    /// Start reading a range of a buffer. Must not be called while a previous request is still in flight
+    /// </summary>
+    /// <param name="sourceBufferID"></param>
+    /// <param name="sourceOffset"></param>
+    /// <param name="sizeInBytes"> Must not be larger than the readback's capacity </param>
+    void Request(const std::uint32_t sourceBufferID, const std::size_t sourceOffset, const std::size_t sizeInBytes)
+    {
+        if(IsPending() == true)
+        {
+            std::cerr << "Readback error: A request was made while the previous one is still in flight\n";
+            __debugbreak();
+        };
+
+        if(sizeInBytes > _capacityInBytes)
+        {
+            std::cerr << "Readback error: A request of " << sizeInBytes << " bytes is larger than the readback (" << _capacityInBytes << " bytes)\n";
+            __debugbreak();
+        };
+
+
+        glBindBuffer(GL_COPY_READ_BUFFER, sourceBufferID);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, _bufferId);
+
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, sourceOffset, 0, sizeInBytes);
+
+        _fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+        // Make sure the fence reaches the GPU even if nothing else is submitted before the readback is polled
+        glFlush();
+
+        _sizeInBytes = sizeInBytes;
+
+        _requested = true;
+        _ready = false;
+    };
+
+
+    /// <summary>
+    /// Check, without waiting, whether the requested data arrived
+    /// </summary>
+    /// <returns></returns>
+    bool IsReady()
+    {
+        if(_fence == nullptr)
+            return _ready;
+
+        if(glClientWaitSync(_fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+            return false;
+
+        glDeleteSync(_fence);
+        _fence = nullptr;
+
+        _ready = true;
+
+        return true;
+    };
+
+    /// <summary>
+    /// Was a request made whose data didn't arrive yet
+    /// </summary>
+    /// <returns></returns>
+    bool IsPending()
+    {
+        return (_requested == true) && (IsReady() == false);
+    };
+
+
+    /// <summary>
+    /// Block until the requested data arrives.
+    /// Only meant for shutting down, or for code that would've called glGetBufferSubData anyway
+    /// </summary>
+    void Wait()
+    {
+        if(_fence == nullptr)
+            return;
+
+        while(glClientWaitSync(_fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1'000'000'000) == GL_TIMEOUT_EXPIRED);
+
+        glDeleteSync(_fence);
+        _fence = nullptr;
+
+        _ready = true;
+    };
+
+
+    /// <summary>
+    /// The requested data. Only valid once IsReady() returned true, and until the next request
+    /// </summary>
+    /// <typeparam name="T"> The type of data that was requested </typeparam>
+    /// <returns></returns>
+    template<typename T>
+    const T* GetData() const
+    {
+        if(_ready == false)
+        {
+            std::cerr << "Readback error: The data was read before it arrived\n";
+            __debugbreak();
+        };
+
+        return reinterpret_cast<const T*>(_mappedBuffer);
+    };
+
+
+public:
+
+    std::size_t GetSizeInBytes() const
+    {
+        return _sizeInBytes;
+    };
+
+    std::size_t GetCapacityInBytes() const
+    {
+        return _capacityInBytes;
+    };
+
+
+public:
+
+    AsyncBufferReadback& operator = (const AsyncBufferReadback&) = delete;
+
+};
\ No newline at end of file
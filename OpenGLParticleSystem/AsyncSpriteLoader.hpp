@@ -0,0 +1,347 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <glad/glad.h>
+#include <glm/vec2.hpp>
+
+#include "SpriteSheet.hpp"
+#include "StreamingBuffer.hpp"
+
+
+/// <summary>
+/// Which of an AsyncSpriteLoader's sprites to use.
+/// Valid as soon as the loader is created, the sprite's layer is transparent until it resolves
+/// </summary>
+struct SpriteHandle
+{
+    std::uint32_t Layer = 0;
+};
+
+
+/// <summary>
+/// Loads a sprite sheet without blocking the GL thread.
+/// Only the sprites' headers are read up front, to allocate the sheet. A pool of worker threads decodes the sprites,
+/// and Update() uploads the decoded ones through a persistently mapped pixel unpack buffer, a limited number of bytes per frame,
+/// so neither the first frame nor a sheet loaded mid-session waits for the decoding. 
+/// A sheet loaded mid-session is handed to the renderer with ParticleSystem::SetSpriteSheet(), its sprites resolve as they're uploaded
+/// </summary>
+class AsyncSpriteLoader
+{
+
+private:
+
+    /// <summary>
+    /// A sprite a worker finished decoding, waiting to be uploaded
+    /// </summary>
+    struct DecodedSprite
+    {
+        std::uint32_t Layer = 0;
+
+        SpriteImage Image;
+    };
+
+
+private:
+
+    std::vector<std::string> _spritePaths;
+
+    SpriteSheet _spriteSheet;
+
+    /// <summary>
+    /// The pixel unpack buffer decoded sprites are copied into, one region per frame in flight.
+    /// A region fits a frame's upload budget, or the largest sprite if it's larger
+    /// </summary>
+    StreamingBuffer _uploadBuffer;
+
+    /// <summary>
+    /// How many bytes of sprites Update() uploads per frame. At least one sprite is uploaded every frame, however large
+    /// </summary>
+    std::size_t _uploadBytesPerFrame = 0;
+
+
+    /// <summary>
+    /// The index, inside _spritePaths, of the next sprite a worker should decode
+    /// </summary>
+    std::atomic<std::size_t> _nextSpriteToDecode = 0;
+
+    /// <summary>
+    /// Set when the loader is destroyed, so workers stop taking sprites
+    /// </summary>
+    std::atomic<bool> _cancelled = false;
+
+    /// <summary>
+    /// Guards _decodedSprites
+    /// </summary>
+    std::mutex _decodedSpritesMutex;
+
+    std::deque<DecodedSprite> _decodedSprites;
+
+    std::vector<std::thread> _workers;
+
+
+    /// <summary>
+    /// Which layers were uploaded. Only accessed on the GL thread
+    /// </summary>
+    std::vector<bool> _readySprites;
+
+    std::uint32_t _numberOfReadySprites = 0;
+
+
+    std::chrono::steady_clock::time_point _loadStart;
+
+    /// <summary>
+    /// From the loader's creation until the last sprite was uploaded
+    /// </summary>
+    std::chrono::duration<float, std::milli> _loadTime = { };
+
+
+public:
+
+    /// <summary>
+    /// Read the sprites' headers, allocate their sprite sheet, and start decoding them
+    /// </summary>
+    /// <param name="spritePaths"> The sprites, in layer order </param>
+    /// <param name="numberOfWorkers"> 0 for one less than the number of hardware threads, leaving one for the GL thread </param>
+    /// <param name="uploadBytesPerFrame"></param>
+    /// <param name="framesInFlight"> How many frames the upload buffer may be in use for at once </param>
+    AsyncSpriteLoader(const std::vector<std::string>& spritePaths,
+                      const std::uint32_t numberOfWorkers = 0,
+                      const std::size_t uploadBytesPerFrame = 4 * 1024 * 1024,
+                      const std::uint32_t framesInFlight = 3) :
+        _spritePaths(spritePaths),
+        _spriteSheet(SpriteSheet::Allocate(ReadSpriteSizes(spritePaths))),
+        _uploadBuffer(std::max(uploadBytesPerFrame, GetLargestSpriteSizeInBytes(_spriteSheet)), framesInFlight),
+        _uploadBytesPerFrame(uploadBytesPerFrame),
+        _readySprites(spritePaths.size(), false),
+        _loadStart(std::chrono::steady_clock::now())
+    {
+        std::uint32_t workers = numberOfWorkers;
+
+        if(workers == 0)
+            workers = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+
+        // A worker per sprite at most, there's nothing for the others to do
+        workers = std::min(workers, static_cast<std::uint32_t>(spritePaths.size()));
+
+        _workers.reserve(workers);
+
+        for(std::uint32_t i = 0; i < workers; i++)
+            _workers.emplace_back(&AsyncSpriteLoader::DecodeSprites, this);
+    };
+
+    AsyncSpriteLoader(const AsyncSpriteLoader&) = delete;
+
+
+    ~AsyncSpriteLoader()
+    {
+        // Sprites that are already being decoded are finished, the rest are skipped
+        _cancelled = true;
+
+        for(std::thread& worker : _workers)
+            worker.join();
+    };
+
+
+public:
+
+    /// <summary>
+    /// Upload sprites the workers finished decoding, up to the per-frame budget, and build the mipmaps of only their layers.
+    /// Call once per frame, on the GL thread
+    /// </summary>
+    void Update()
+    {
+        if(IsFinished() == true)
+            return;
+
+
+        TextureArray& textureArray = _spriteSheet.GetTextureArray();
+
+        std::size_t uploadedBytes = 0;
+
+        std::vector<std::uint32_t> uploadedLayers;
+
+
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, _uploadBuffer.GetBufferID());
+
+        while(true)
+        {
+            DecodedSprite decodedSprite;
+
+            {
+                const std::lock_guard lock = std::lock_guard(_decodedSpritesMutex);
+
+                if(_decodedSprites.empty() == true)
+                    break;
+
+                if((uploadedLayers.empty() == false) &&
+                   ((uploadedBytes + _decodedSprites.front().Image.Pixels.size()) > _uploadBytesPerFrame))
+                    break;
+
+                decodedSprite = std::move(_decodedSprites.front());
+                _decodedSprites.pop_front();
+            };
+
+
+            const SpriteImage& image = decodedSprite.Image;
+
+            // A sprite that failed to decode stays transparent, but still counts as resolved
+            if(image.Pixels.empty() == false)
+            {
+                const StreamingBuffer::Allocation allocation = _uploadBuffer.Allocate(image.Pixels.size());
+
+                std::memcpy(allocation.Data, image.Pixels.data(), image.Pixels.size());
+
+                // Sourced from the bound unpack buffer, the copy to the texture happens on the GPU's own time
+                textureArray.SetLayer(decodedSprite.Layer, 0, 0, image.Width, image.Height, reinterpret_cast<const std::uint8_t*>(allocation.Offset));
+
+                uploadedBytes += image.Pixels.size();
+
+                uploadedLayers.push_back(decodedSprite.Layer);
+            };
+
+            _readySprites[decodedSprite.Layer] = true;
+            _numberOfReadySprites++;
+        };
+
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+
+        if(uploadedLayers.empty() == false)
+        {
+            // The cost follows this frame's uploads, not the size of the whole sheet
+            for(const std::uint32_t layer : uploadedLayers)
+                textureArray.GenerateLayerMipmaps(layer);
+
+            // The region is reused once the GPU finished this frame's copies
+            _uploadBuffer.NextFrame();
+        };
+
+
+        if(IsFinished() == true)
+            _loadTime = std::chrono::steady_clock::now() - _loadStart;
+    };
+
+
+public:
+
+    const SpriteSheet& GetSpriteSheet() const
+    {
+        return _spriteSheet;
+    };
+
+    /// <summary>
+    /// The handle of a sprite, by its index in the paths the loader was created with
+    /// </summary>
+    /// <param name="spriteIndex"></param>
+    /// <returns></returns>
+    SpriteHandle GetSprite(const std::uint32_t spriteIndex) const
+    {
+        return { spriteIndex };
+    };
+
+    /// <summary>
+    /// If a sprite was uploaded, and draws as itself instead of transparent
+    /// </summary>
+    /// <param name="sprite"></param>
+    /// <returns></returns>
+    bool IsReady(const SpriteHandle sprite) const
+    {
+        return _readySprites[sprite.Layer];
+    };
+
+    /// <summary>
+    /// If every sprite was uploaded
+    /// </summary>
+    /// <returns></returns>
+    bool IsFinished() const
+    {
+        return _numberOfReadySprites == _spritePaths.size();
+    };
+
+    std::uint32_t GetNumberOfReadySprites() const
+    {
+        return _numberOfReadySprites;
+    };
+
+    std::uint32_t GetNumberOfSprites() const
+    {
+        return static_cast<std::uint32_t>(_spritePaths.size());
+    };
+
+    std::uint32_t GetNumberOfWorkers() const
+    {
+        return static_cast<std::uint32_t>(_workers.size());
+    };
+
+    /// <summary>
+    /// From the loader's creation until the last sprite was uploaded. Zero until IsFinished()
+    /// </summary>
+    /// <returns></returns>
+    std::chrono::duration<float, std::milli> GetLoadTime() const
+    {
+        return _loadTime;
+    };
+
+
+public:
+
+    AsyncSpriteLoader& operator = (const AsyncSpriteLoader&) = delete;
+
+
+private:
+
+    /// <summary>
+    /// A worker's loop. Takes the next sprite until there are none left
+    /// </summary>
+    void DecodeSprites()
+    {
+        while(_cancelled == false)
+        {
+            const std::size_t spriteIndex = _nextSpriteToDecode.fetch_add(1);
+
+            if(spriteIndex >= _spritePaths.size())
+                return;
+
+            SpriteImage image = SpriteSheet::LoadSpriteImage(_spritePaths[spriteIndex]);
+
+            const std::lock_guard lock = std::lock_guard(_decodedSpritesMutex);
+
+            _decodedSprites.push_back({ static_cast<std::uint32_t>(spriteIndex), std::move(image) });
+        };
+    };
+
+
+    static std::vector<glm::uvec2> ReadSpriteSizes(const std::vector<std::string>& spritePaths)
+    {
+        std::vector<glm::uvec2> spriteSizes;
+        spriteSizes.reserve(spritePaths.size());
+
+        for(const std::string& spritePath : spritePaths)
+            spriteSizes.push_back(SpriteSheet::ReadSpriteSize(spritePath));
+
+        return spriteSizes;
+    };
+
+    /// <summary>
+    /// A layer is as large as the largest sprite
+    /// </summary>
+    /// <param name="spriteSheet"></param>
+    /// <returns></returns>
+    static std::size_t GetLargestSpriteSizeInBytes(const SpriteSheet& spriteSheet)
+    {
+        const TextureArray& textureArray = spriteSheet.GetTextureArray();
+
+        return static_cast<std::size_t>(textureArray.GetWidth()) * textureArray.GetHeight() * 4;
+    };
+
+};
\ No newline at end of file
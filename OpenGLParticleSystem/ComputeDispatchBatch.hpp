@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <glad/glad.h>
+
+#include "ComputeShaderProgram.hpp"
+
+
+/// <summary>
+/// Records compute dispatches that don't depend on each other, and issues a single memory barrier once their results are about to be consumed.
+/// Unlike ComputeShaderProgram::Dispatch(), no barrier is placed between the recorded dispatches, so the GPU is free to overlap them
+/// </summary>
+class ComputeDispatchBatch
+{
+
+private:
+
+    /// <summary>
+    /// The number of dispatches since the last Submit()
+    /// </summary>
+    std::uint32_t _numberOfPendingDispatches = 0;
+
+    /// <summary>
+    /// The number of dispatches the last Submit() placed a barrier after
+    /// </summary>
+    std::uint32_t _numberOfSubmittedDispatches = 0;
+
+
+public:
+
+    /// <summary>
+    /// Dispatch a compute shader's work groups, without a barrier.
+    /// The dispatch must not read anything another dispatch of the same batch writes
+    /// </summary>
+    /// <param name="computeShaderProgram"></param>
+    /// <param name="dispatchGroupsX"></param>
+    /// <param name="dispatchGroupsY"></param>
+    /// <param name="dispatchGroupsZ"></param>
+    void Dispatch(const ComputeShaderProgram& computeShaderProgram, const std::uint32_t dispatchGroupsX = 1, const std::uint32_t dispatchGroupsY = 1, const std::uint32_t dispatchGroupsZ = 1)
+    {
+        computeShaderProgram.Bind();
+
+        glDispatchCompute(dispatchGroupsX, dispatchGroupsY, dispatchGroupsZ);
+
+        _numberOfPendingDispatches++;
+    };
+
+
+    /// <summary>
+    /// Make the results of every recorded dispatch visible to whatever consumes them next. Does nothing if nothing was dispatched
+    /// </summary>
+    /// <param name="barrierBits"> How the results are consumed, for example GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT before drawing them </param>
+    void Submit(const GLbitfield barrierBits)
+    {
+        if(_numberOfPendingDispatches == 0)
+            return;
+
+        glMemoryBarrier(barrierBits);
+
+        _numberOfSubmittedDispatches = _numberOfPendingDispatches;
+        _numberOfPendingDispatches = 0;
+    };
+
+
+public:
+
+    std::uint32_t GetNumberOfPendingDispatches() const
+    {
+        return _numberOfPendingDispatches;
+    };
+
+    /// <summary>
+    /// How many dispatches shared the last barrier
+    /// </summary>
+    /// <returns></returns>
+    std::uint32_t GetNumberOfSubmittedDispatches() const
+    {
+        return _numberOfSubmittedDispatches;
+    };
+
+};
\ No newline at end of file
@@ -0,0 +1,201 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <functional>
+#include <iostream>
+#include <glad/glad.h>
+
+#include "ComputeShaderProgram.hpp"
+
+
+/// <summary>
+/// Picks the fastest work group size, and number of items per invocation, of a compute shader on the current driver.
+/// Every combination is compiled as a variant of the shader with both values injected as defines, and timed on the GPU with a timer query
+/// </summary>
+class ComputeShaderAutoTuner
+{
+
+public:
+
+    /// <summary>
+    /// A compiled combination, and how long it took
+    /// </summary>
+    struct Variant
+    {
+        std::uint32_t WorkGroupSize = 0;
+        std::uint32_t ItemsPerInvocation = 0;
+
+        /// <summary>
+        /// The average GPU time of a single dispatch
+        /// </summary>
+        float Milliseconds = 0.0f;
+    };
+
+
+private:
+
+    std::string _shaderPath;
+
+    /// <summary>
+    /// The names of the defines the shader reads its work group size and items per invocation from
+    /// </summary>
+    std::string _workGroupSizeDefine;
+    std::string _itemsPerInvocationDefine;
+
+    std::vector<Variant> _variants;
+
+    /// <summary>
+    /// The program of every variant, in the same order
+    /// </summary>
+    std::vector<ComputeShaderProgram> _programs;
+
+    std::size_t _fastestVariant = 0;
+
+
+public:
+
+    ComputeShaderAutoTuner(const std::string_view& shaderPath, const std::string_view& workGroupSizeDefine, const std::string_view& itemsPerInvocationDefine) :
+        _shaderPath(shaderPath),
+        _workGroupSizeDefine(workGroupSizeDefine),
+        _itemsPerInvocationDefine(itemsPerInvocationDefine)
+    {
+    };
+
+    ComputeShaderAutoTuner(const ComputeShaderAutoTuner&) = delete;
+
+
+public:
+
+    /// <summary>
+    /// Compile and time every combination of work group size and items per invocation.
+    /// Work group sizes the driver doesn't support are skipped
+    /// </summary>
+    /// <param name="workGroupSizes"></param>
+    /// <param name="itemsPerInvocation"></param>
+    /// <param name="setup"> Makes the given variant current, once per variant. Not timed </param>
+    /// <param name="dispatch"> Dispatches the same work with the given variant. Everything it issues is timed </param>
+    /// <param name="repetitions"> How many times every variant is dispatched, after a warm-up dispatch </param>
+    /// <returns> The fastest variant's program, which lives as long as the tuner </returns>
+    const ComputeShaderProgram& Tune(const std::vector<std::uint32_t>& workGroupSizes,
+                                     const std::vector<std::uint32_t>& itemsPerInvocation,
+                                     const std::function<void(const ComputeShaderProgram&)>& setup,
+                                     const std::function<void(const ComputeShaderProgram&)>& dispatch,
+                                     const std::uint32_t repetitions)
+    {
+        GLint maxWorkGroupSize = 0;
+        glGetIntegeri_v(GL_MAX_COMPUTE_WORK_GROUP_SIZE, 0, &maxWorkGroupSize);
+
+        GLint maxWorkGroupInvocations = 0;
+        glGetIntegerv(GL_MAX_COMPUTE_WORK_GROUP_INVOCATIONS, &maxWorkGroupInvocations);
+
+
+        _variants.clear();
+        _programs.clear();
+
+        _fastestVariant = 0;
+
+        _variants.reserve(workGroupSizes.size() * itemsPerInvocation.size());
+        _programs.reserve(workGroupSizes.size() * itemsPerInvocation.size());
+
+        for(const std::uint32_t workGroupSize : workGroupSizes)
+        {
+            if((workGroupSize > static_cast<std::uint32_t>(maxWorkGroupSize)) ||
+               (workGroupSize > static_cast<std::uint32_t>(maxWorkGroupInvocations)))
+                continue;
+
+            for(const std::uint32_t items : itemsPerInvocation)
+            {
+                _variants.push_back({ .WorkGroupSize = workGroupSize, .ItemsPerInvocation = items });
+
+                _programs.emplace_back(_shaderPath, std::vector<ComputeShaderDefine>
+                {
+                    { _workGroupSizeDefine, std::to_string(workGroupSize) },
+                    { _itemsPerInvocationDefine, std::to_string(items) },
+                });
+            };
+        };
+
+        if(_programs.empty() == true)
+        {
+            std::cerr << "Compute shader auto-tuner error: No variant of \"" << _shaderPath << "\" is supported\n";
+            __debugbreak();
+        };
+
+
+        std::uint32_t timerQuery = 0;
+        glGenQueries(1, &timerQuery);
+
+        for(std::size_t i = 0; i < _programs.size(); i++)
+        {
+            setup(_programs[i]);
+
+            // The first dispatch of a program may include the driver's lazy compilation
+            dispatch(_programs[i]);
+
+            glBeginQuery(GL_TIME_ELAPSED, timerQuery);
+
+            for(std::uint32_t repetition = 0; repetition < repetitions; repetition++)
+                dispatch(_programs[i]);
+
+            glEndQuery(GL_TIME_ELAPSED);
+
+            // Waits for the GPU, which is fine when tuning
+            GLuint64 elapsedNanoseconds = 0;
+            glGetQueryObjectui64v(timerQuery, GL_QUERY_RESULT, &elapsedNanoseconds);
+
+            _variants[i].Milliseconds = (elapsedNanoseconds / 1'000'000.0f) / repetitions;
+
+            if(_variants[i].Milliseconds < _variants[_fastestVariant].Milliseconds)
+                _fastestVariant = i;
+        };
+
+        glDeleteQueries(1, &timerQuery);
+
+
+        return GetFastestProgram();
+    };
+
+
+    /// <summary>
+    /// Print every variant's timing
+    /// </summary>
+    void PrintResults() const
+    {
+        std::cout << "Auto-tuned \"" << _shaderPath << "\":\n";
+
+        for(std::size_t i = 0; i < _variants.size(); i++)
+        {
+            const Variant& variant = _variants[i];
+
+            std::cout << "    " << _workGroupSizeDefine << " " << variant.WorkGroupSize << ", " << _itemsPerInvocationDefine << " " << variant.ItemsPerInvocation << ": "
+                << variant.Milliseconds << "ms" << ((i == _fastestVariant) ? " (fastest)" : "") << "\n";
+        };
+    };
+
+
+public:
+
+    const std::vector<Variant>& GetVariants() const
+    {
+        return _variants;
+    };
+
+    const Variant& GetFastestVariant() const
+    {
+        return _variants[_fastestVariant];
+    };
+
+    const ComputeShaderProgram& GetFastestProgram() const
+    {
+        return _programs[_fastestVariant];
+    };
+
+
+public:
+
+    ComputeShaderAutoTuner& operator = (const ComputeShaderAutoTuner&) = delete;
+
+};
\ No newline at end of file
@@ -1,12 +1,28 @@
 #pragma once
 
-#include <unordered_map>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <array>
 #include <glad/glad.h>
 #include <glm/mat4x4.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <fstream>
 #include <iostream>
 
+#include "GLUtilities.hpp"
+#include "ShaderUniforms.hpp"
+
+
+/// <summary>
+/// A '#define' that is injected into a compute shader's source, right after its '#version' directive
+/// </summary>
+struct ComputeShaderDefine
+{
+    std::string Name;
+    std::string Value;
+};
+
 
 /// <summary>
 /// A class that encapsulates the functionality of a compute shader
@@ -16,9 +32,14 @@ class ComputeShaderProgram
 private:
 
     /// <summary>
-    /// A list of known uniform locations
+    /// The defines this variant of the shader was compiled with
     /// </summary>
-    mutable std::unordered_map<std::string, std::uint32_t> _uniformLocations;
+    std::vector<ComputeShaderDefine> _defines;
+
+    /// <summary>
+    /// Every active uniform, found when the program was linked
+    /// </summary>
+    mutable ShaderUniformTable _uniforms;
 
     /// <summary>
     /// The ID of this shader 
@@ -28,15 +49,38 @@ private:
 
 public:
 
-    ComputeShaderProgram(const std::string_view& shaderPath)
+    ComputeShaderProgram(const std::string_view& shaderPath) :
+        ComputeShaderProgram(shaderPath, { })
+    {
+    };
+
+    /// <summary>
+    /// Compile a variant of a compute shader
+    /// </summary>
+    /// <param name="shaderPath"></param>
+    /// <param name="defines"> Defines the shader's source is compiled with, for example its work group size </param>
+    ComputeShaderProgram(const std::string_view& shaderPath, const std::vector<ComputeShaderDefine>& defines) :
+        _defines(defines)
     {
         const std::uint32_t computeShaderID = CreateAndCompileShader(shaderPath);
 
         _programID = CreateAndLinkProgram(computeShaderID);
 
+        _uniforms.Reflect(_programID);
+
         Bind();
     };
 
+    ComputeShaderProgram(ComputeShaderProgram&& other) noexcept :
+        _defines(std::move(other._defines)),
+        _uniforms(std::move(other._uniforms)),
+        _programID(other._programID)
+    {
+        other._programID = 0;
+    };
+
+    ComputeShaderProgram(const ComputeShaderProgram&) = delete;
+
     ~ComputeShaderProgram()
     {
         if(_programID != 0)
@@ -52,47 +96,46 @@ public:
     };
 
 
+    /// <summary>
+    /// Find a uniform once, so it can be set every frame without looking its name up
+    /// </summary>
+    /// <typeparam name="T"></typeparam>
+    /// <param name="uniformName"></param>
+    /// <returns></returns>
     template<typename T>
-    void SetUniformValue(const std::string_view& uniformName, const T& value) const
+    UniformHandle<T> GetUniformHandle(const std::string_view& uniformName) const
     {
-        static_assert(false, "Unsupported type");
+        return _uniforms.GetHandle<T>(uniformName);
     };
 
-
-    template<>
-    void SetUniformValue(const std::string_view& uniformName, const float& value) const
+    /// <summary>
+    /// Set a uniform. Nothing is sent if it already has this value, and the program doesn't have to be bound
+    /// </summary>
+    /// <typeparam name="T"></typeparam>
+    /// <param name="handle"></param>
+    /// <param name="value"></param>
+    template<typename T>
+    void SetUniform(const UniformHandle<T> handle, const T& value) const
     {
-        Bind();
-
-        const std::uint32_t uniformLocation = GetUniformLocation(uniformName.data());
-        glUniform1f(uniformLocation, value);
+        _uniforms.Set(handle, value);
     };
 
-
-    template<>
-    void SetUniformValue(const std::string_view& uniformName, const glm::mat4& value) const
+    /// <summary>
+    /// Set a uniform by name, which looks it up every call. Prefer handles for anything set every frame
+    /// </summary>
+    /// <typeparam name="T"></typeparam>
+    /// <param name="uniformName"></param>
+    /// <param name="value"></param>
+    template<typename T>
+    void SetUniformValue(const std::string_view& uniformName, const T& value) const
     {
-        Bind();
-
-        const std::uint32_t uniformLocation = GetUniformLocation(uniformName.data());
-
-        glUniformMatrix4fv(uniformLocation, 1, false, glm::value_ptr(value));
-    };
-
-
-    template<>
-    void SetUniformValue(const std::string_view& uniformName, const std::uint32_t& value) const
-    {
-        Bind();
-
-        const std::uint32_t uniformLocation = GetUniformLocation(uniformName.data());
-
-        glUniform1ui(uniformLocation, value);
+        SetUniform(GetUniformHandle<T>(uniformName), value);
     };
 
 
     /// <summary>
-    /// Dispatch a compute shader work groups
+    /// Dispatch a compute shader work groups, and wait for its SSBO writes before anything else runs. 
+    /// Dispatches that don't depend on each other should go through a ComputeDispatchBatch instead
     /// </summary>
     /// <param name="dispatchGroupsX"></param>
     /// <param name="dispatchGroupsY"></param>
@@ -116,31 +159,72 @@ public:
         return _programID;
     };
 
+    /// <summary>
+    /// The shader's local_size_x, local_size_y and local_size_z, as it was linked
+    /// </summary>
+    /// <returns></returns>
+    std::array<std::uint32_t, 3> GetWorkGroupSize() const
+    {
+        GLint workGroupSize[3] = { };
+        glGetProgramiv(_programID, GL_COMPUTE_WORK_GROUP_SIZE, workGroupSize);
 
-private:
+        return { static_cast<std::uint32_t>(workGroupSize[0]), static_cast<std::uint32_t>(workGroupSize[1]), static_cast<std::uint32_t>(workGroupSize[2]) };
+    };
+
+    /// <summary>
+    /// The value of a define the shader was compiled with, as a number
+    /// </summary>
+    /// <param name="name"></param>
+    /// <param name="defaultValue"> Returned if the shader wasn't compiled with the define, should match the shader's own default </param>
+    /// <returns></returns>
+    std::uint32_t GetDefineValue(const std::string_view& name, const std::uint32_t defaultValue) const
+    {
+        for(const ComputeShaderDefine& define : _defines)
+        {
+            if(define.Name == name)
+                return static_cast<std::uint32_t>(std::stoul(define.Value));
+        };
+
+        return defaultValue;
+    };
+
+    const std::vector<ComputeShaderDefine>& GetDefines() const
+    {
+        return _defines;
+    };
 
 
+private:
+
     /// <summary>
-    /// Read all text inside a file
+    /// Insert a '#define' line for every define right after the '#version' directive, which must stay the first line of the source
     /// </summary>
-    /// <param name="filename"> Path to sid file </param>
+    /// <param name="source"></param>
     /// <returns></returns>
-    std::string ReadAllText(const std::string& filename)
+    std::string InjectDefines(std::string source) const
     {
-        // Open the file at the end so we can easily find its length
-        std::ifstream fileStream = std::ifstream(filename, std::ios::ate);
+        if(_defines.empty() == true)
+            return source;
+
+        std::string defineLines;
 
-        std::string fileContents;
+        for(const ComputeShaderDefine& define : _defines)
+            defineLines.append("#define ").append(define.Name).append(" ").append(define.Value).append("\n");
 
-        // Resize the buffer to fit content
-        fileContents.resize(fileStream.tellg());
+        const std::size_t versionPosition = source.find("#version");
 
-        fileStream.seekg(std::ios::beg);
+        // Without a '#version' directive the defines can go first
+        if(versionPosition == std::string::npos)
+            return source.insert(0, defineLines);
 
-        // Read file contents into the buffer
-        fileStream.read(fileContents.data(), fileContents.size());
+        const std::size_t versionLineEnd = source.find('\n', versionPosition);
+
+        if(versionLineEnd == std::string::npos)
+            source.append("\n").append(defineLines);
+        else
+            source.insert(versionLineEnd + 1, defineLines);
 
-        return fileContents;
+        return source;
     };
 
 
@@ -148,7 +232,7 @@ private:
     {
         const std::uint32_t computeShaderID = glCreateShader(GL_COMPUTE_SHADER);
 
-        const auto computeShaderSource = ReadAllText(shaderPath.data());
+        const auto computeShaderSource = InjectDefines(GL::ReadShaderSource(shaderPath.data()));
 
 
         const char* computeShaderSourcePointer = computeShaderSource.c_str();
@@ -215,43 +299,4 @@ private:
         return computeShaderProgramID;
     };
 
-
-    /// <summary>
-    /// Find the location of a uniform
-    /// </summary>
-    /// <param name="name"></param>
-    /// <returns></returns>
-    std::uint32_t GetUniformLocation(const std::string& name) const
-    {
-        // Check if uniform exists in cache
-        const auto result = _uniformLocations.find(name);
-
-        int uniformLocation = -1;
-
-        // If name uniform isn't cached...
-        if(result == _uniformLocations.cend())
-        {
-            // Find the uniform
-            uniformLocation = glGetUniformLocation(_programID, name.c_str());
-
-            if(uniformLocation == -1)
-            {
-                std::cerr << "Uniform location error: Unable to find \"" << name << "\"\n";
-                __debugbreak();
-            }
-            else
-            {
-                // Add to cache
-                _uniformLocations.insert(std::make_pair(name, static_cast<std::uint32_t>(uniformLocation)));
-            };
-        }
-        // If uniform was found...
-        else
-        {
-            uniformLocation = result->second;
-        };
-
-        return uniformLocation;
-    };
-
 };
\ No newline at end of file
@@ -0,0 +1,498 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <glm/vec4.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/packing.hpp>
+
+// Pick the widest instruction set the compiler was allowed to use.
+// MSVC only defines __AVX2__ with /arch:AVX2, and always has SSE2 on x64
+#if defined(__AVX2__)
+    #define PARTICLE_SIMULATION_AVX2
+    #include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+    #define PARTICLE_SIMULATION_SSE
+    #include <immintrin.h>
+#endif
+
+#include "Math.hpp"
+#include "Particle.hpp"
+
+
+/// <summary>
+/// A CPU implementation of ParticleTransformShader.glsl that doesn't require a GL context.
+/// Particles are stored as a structure-of-arrays so the update can be vectorized
+/// </summary>
+class CpuParticleSimulation
+{
+
+public:
+
+#if defined(PARTICLE_SIMULATION_AVX2)
+    static constexpr std::size_t SimdWidth = 8;
+#elif defined(PARTICLE_SIMULATION_SSE)
+    static constexpr std::size_t SimdWidth = 4;
+#else
+    static constexpr std::size_t SimdWidth = 1;
+#endif
+
+
+private:
+
+    /// <summary>
+    /// The number of "real" particles, the streams themselves are padded to a multiple of SimdWidth
+    /// </summary>
+    std::size_t _numberOfParticles = 0;
+
+    /// <summary>
+    /// The particles' random streams are keyed by these, the same way the compute shaders key them
+    /// </summary>
+    std::uint32_t _seed = 0;
+    std::uint32_t _emitterIndex = 0;
+    std::uint32_t _firstParticle = 0;
+
+
+    std::vector<float> _trajectoryA;
+    std::vector<float> _trajectoryB;
+
+    std::vector<float> _trajectoryX;
+
+    std::vector<float> _rate;
+
+    std::vector<float> _opacity;
+    std::vector<float> _opacityDecreaseRate;
+
+
+    /// <summary>
+    /// The resulting (NDC position, Scale, Opacity) of every particle, laid out exactly like OutParticleInstances
+    /// </summary>
+    std::vector<glm::vec4> _instances;
+
+
+public:
+
+    CpuParticleSimulation(const std::size_t numberOfParticles) :
+        _numberOfParticles(numberOfParticles),
+        _instances(numberOfParticles)
+    {
+        const std::size_t paddedSize = ((numberOfParticles + SimdWidth - 1) / SimdWidth) * SimdWidth;
+
+        for(std::vector<float>* stream : { &_trajectoryA, &_trajectoryB, &_trajectoryX, &_rate, &_opacity, &_opacityDecreaseRate })
+        {
+            stream->resize(paddedSize, 0.0f);
+        };
+    };
+
+
+public:
+
+    /// <summary>
+    /// Copy particle state (Usually read back from the input SSBO) into the simulation
+    /// </summary>
+    /// <param name="particles"> A pointer to at least GetNumberOfParticles() particles, all of the same emitter </param>
+    /// <param name="firstParticle"> The index of the first particle inside the particle buffer </param>
+    /// <param name="seed"> The emitter's seed </param>
+    void Load(const ComputeShaderParticle* particles, const std::uint32_t firstParticle, const std::uint32_t seed)
+    {
+        _seed = seed;
+        _firstParticle = firstParticle;
+
+        if(_numberOfParticles > 0)
+            _emitterIndex = particles[0].EmitterIndex;
+
+        for(std::size_t i = 0; i < _numberOfParticles; i++)
+        {
+            const ComputeShaderParticle& particle = particles[i];
+
+            const glm::vec2 trajectory = glm::unpackHalf2x16(particle.PackedTrajectory);
+            const glm::vec2 rates = glm::unpackHalf2x16(particle.PackedRates);
+
+            _trajectoryA[i] = trajectory.x;
+            _trajectoryB[i] = trajectory.y;
+
+            _trajectoryX[i] = particle.TrajectoryX;
+
+            _rate[i] = rates.x;
+
+            _opacity[i] = particle.Opacity;
+            _opacityDecreaseRate[i] = rates.y;
+        };
+    };
+
+
+    /// <summary>
+    /// Copy the simulation's particle state back into the compute shader's layout.
+    /// Fields the simulation doesn't own (Like the EmitterIndex) are left untouched
+    /// </summary>
+    /// <param name="particles"> A pointer to at least GetNumberOfParticles() particles </param>
+    void Store(ComputeShaderParticle* particles) const
+    {
+        for(std::size_t i = 0; i < _numberOfParticles; i++)
+        {
+            ComputeShaderParticle& particle = particles[i];
+
+            particle.TrajectoryX = _trajectoryX[i];
+            particle.Opacity = _opacity[i];
+
+            particle.PackedTrajectory = glm::packHalf2x16({ _trajectoryA[i], _trajectoryB[i] });
+            particle.PackedRates = glm::packHalf2x16({ _rate[i], _opacityDecreaseRate[i] });
+        };
+    };
+
+
+    /// <summary>
+    /// Reset every particle, the same way ParticleSeedShader.glsl seeds an emitter
+    /// </summary>
+    /// <param name="emitterParameters"> The emitter's parameters, as the seeding shader sees them </param>
+    /// <param name="emitterIndex"></param>
+    /// <param name="firstParticle"> The index of the first particle inside the particle buffer </param>
+    /// <param name="frame"> The particle system's frame at the time of seeding </param>
+    void Initialize(const EmitterParameters& emitterParameters, const std::uint32_t emitterIndex, const std::uint32_t firstParticle, const std::uint32_t frame)
+    {
+        _seed = emitterParameters.Seed;
+        _emitterIndex = emitterIndex;
+        _firstParticle = firstParticle;
+
+        for(std::size_t i = 0; i < _numberOfParticles; i++)
+        {
+            ResetParticle(i, emitterParameters.Behaviour, frame);
+        };
+    };
+
+
+    /// <summary>
+    /// Advance every particle by one frame. Mirrors 'main()' in ParticleTransformShader.glsl
+    /// </summary>
+    /// <param name="deltaTime"></param>
+    /// <param name="emitterParameters"> The emitter's parameters, as the compute shader sees them </param>
+    /// <param name="windowWidth"></param>
+    /// <param name="windowHeight"></param>
+    /// <param name="particleScaleFactor"></param>
+    /// <param name="frame"> The particle system's frame, keys the random streams of particles that reset </param>
+    void Step(const float deltaTime, const EmitterParameters& emitterParameters, const float windowWidth, const float windowHeight, const float particleScaleFactor, const std::uint32_t frame)
+    {
+        const StepConstants constants = GetStepConstants(deltaTime, emitterParameters, windowWidth, windowHeight, particleScaleFactor, frame);
+
+        // Written by the SIMD loop, and interleaved into instances afterwards
+        alignas(32) float screenPositionX[SimdWidth];
+        alignas(32) float screenPositionY[SimdWidth];
+
+        alignas(32) float opacities[SimdWidth];
+
+
+        for(std::size_t blockStart = 0; blockStart < _numberOfParticles; blockStart += SimdWidth)
+        {
+            const std::size_t blockEnd = std::min(blockStart + SimdWidth, _numberOfParticles);
+
+            // Dead particles of a draining emitter are stepped with the rest of the block, and then put back as they were
+            alignas(32) float deadTrajectoryX[SimdWidth];
+            int deadLanes = 0;
+
+            if(constants.Draining == true)
+            {
+                for(std::size_t i = blockStart; i < blockEnd; i++)
+                {
+                    if(_opacity[i] <= 0.0f)
+                    {
+                        deadLanes |= 1 << (i - blockStart);
+                        deadTrajectoryX[i - blockStart] = _trajectoryX[i];
+                    };
+                };
+            };
+
+
+            StepBlock(blockStart, constants, screenPositionX, screenPositionY, opacities);
+
+            for(std::size_t i = blockStart; i < blockEnd; i++)
+            {
+                const std::size_t lane = i - blockStart;
+
+                if((deadLanes & (1 << lane)) != 0)
+                {
+                    _trajectoryX[i] = deadTrajectoryX[lane];
+                    _opacity[i] = 0.0f;
+
+                    _instances[i] = glm::vec4(0.0f);
+                }
+                else
+                    _instances[i] = { screenPositionX[lane], screenPositionY[lane], constants.Scale, opacities[lane] };
+            };
+        };
+    };
+
+
+public:
+
+    std::size_t GetNumberOfParticles() const
+    {
+        return _numberOfParticles;
+    };
+
+    /// <summary>
+    /// The (NDC position, Scale, Opacity) of every particle after the last Step()
+    /// </summary>
+    /// <returns></returns>
+    const std::vector<glm::vec4>& GetInstances() const
+    {
+        return _instances;
+    };
+
+
+    /// <summary>
+    /// The name of the instruction set the simulation was compiled with
+    /// </summary>
+    /// <returns></returns>
+    static constexpr const char* GetSimdPathName()
+    {
+    #if defined(PARTICLE_SIMULATION_AVX2)
+        return "AVX2";
+    #elif defined(PARTICLE_SIMULATION_SSE)
+        return "SSE";
+    #else
+        return "Scalar";
+    #endif
+    };
+
+
+private:
+
+    /// <summary>
+    /// Values that are uniform across a Step() call
+    /// </summary>
+    struct StepConstants
+    {
+        float DeltaTime = 0.0f;
+
+        // Cartesian to NDC, divided by the particle scale factor
+        float CartesianToScaledNDCX = 0.0f;
+        float CartesianToScaledNDCY = 0.0f;
+
+        // See EmitterParameters
+        glm::vec2 Origin = glm::vec2(0.0f);
+        glm::vec2 AxisX = glm::vec2(0.0f);
+        glm::vec2 AxisY = glm::vec2(0.0f);
+        float Scale = 0.0f;
+
+        bool Draining = false;
+
+        /// <summary>
+        /// The ranges and direction particles that reset are given
+        /// </summary>
+        EmitterBehaviour Behaviour;
+
+        std::uint32_t Frame = 0;
+    };
+
+
+    /// <summary>
+    /// Same as 'InitializeParticleValues' in ParticleShaderCommon.glsl, values are drawn from the particle's stream in the same order
+    /// </summary>
+    /// <param name="i"></param>
+    /// <param name="behaviour"></param>
+    /// <param name="frame"></param>
+    void ResetParticle(const std::size_t i, const EmitterBehaviour& behaviour, const std::uint32_t frame)
+    {
+        const std::uint32_t particleIndex = _firstParticle + static_cast<std::uint32_t>(i);
+
+        RandomStream stream = CreateRandomStream(_seed, _emitterIndex, particleIndex, frame);
+
+
+        const bool left = ((behaviour.Flags & EmitterBehaviour::AlternateDirectionsFlag) != 0) ?
+            // A very simple way of creating some trajectory variation
+            ((particleIndex % 2) == 0) :
+            ((behaviour.Flags & EmitterBehaviour::LeftDirectionFlag) != 0);
+
+
+        const float newTrajectoryA = RandomNumberGenerator(stream, behaviour.TrajectoryARange.x, behaviour.TrajectoryARange.y);
+
+        const float newTrajectoryB = left ?
+            -RandomNumberGenerator(stream, behaviour.TrajectoryBRange.x, behaviour.TrajectoryBRange.y) :
+            RandomNumberGenerator(stream, behaviour.TrajectoryBRange.x, behaviour.TrajectoryBRange.y);
+
+        // Correct the rate depending on trajectory direction
+        const float newRate = left ?
+            -RandomNumberGenerator(stream, behaviour.RateRange.x, behaviour.RateRange.y) :
+            RandomNumberGenerator(stream, behaviour.RateRange.x, behaviour.RateRange.y);
+
+        const float newOpacityDecreaseRate = RandomNumberGenerator(stream, behaviour.OpacityDecreaseRateRange.x, behaviour.OpacityDecreaseRateRange.y);
+
+
+        // The compute shader stores these as half-floats
+        const glm::vec2 trajectory = glm::unpackHalf2x16(glm::packHalf2x16({ newTrajectoryA, newTrajectoryB }));
+        const glm::vec2 rates = glm::unpackHalf2x16(glm::packHalf2x16({ newRate, newOpacityDecreaseRate }));
+
+        _trajectoryA[i] = trajectory.x;
+        _trajectoryB[i] = trajectory.y;
+
+        _trajectoryX[i] = 0.0f;
+
+        _rate[i] = rates.x;
+
+        _opacity[i] = 1.0f;
+        _opacityDecreaseRate[i] = rates.y;
+    };
+
+
+    static StepConstants GetStepConstants(const float deltaTime, const EmitterParameters& emitterParameters, const float windowWidth, const float windowHeight, const float particleScaleFactor, const std::uint32_t frame)
+    {
+        return
+        {
+            .DeltaTime = deltaTime,
+
+            .CartesianToScaledNDCX = 2.0f / (windowWidth * particleScaleFactor),
+            .CartesianToScaledNDCY = 2.0f / (windowHeight * particleScaleFactor),
+
+            .Origin = emitterParameters.Origin,
+            .AxisX = emitterParameters.AxisX,
+            .AxisY = emitterParameters.AxisY,
+            .Scale = emitterParameters.Scale,
+
+            .Draining = (emitterParameters.Draining != 0),
+
+            .Behaviour = emitterParameters.Behaviour,
+
+            .Frame = frame,
+        };
+    };
+
+
+    /// <summary>
+    /// Update SimdWidth particles starting at blockStart.
+    /// A particle's screen position is 'Origin + AxisX * ndc.x + AxisY * ndc.y', where ndc is its scaled NDC trajectory position
+    /// </summary>
+    void StepBlock(const std::size_t blockStart, const StepConstants& constants, float* outputScreenPositionX, float* outputScreenPositionY, float* outputOpacities)
+    {
+        float* const trajectoryA = _trajectoryA.data() + blockStart;
+        float* const trajectoryB = _trajectoryB.data() + blockStart;
+        float* const trajectoryX = _trajectoryX.data() + blockStart;
+        float* const rate = _rate.data() + blockStart;
+        float* const opacity = _opacity.data() + blockStart;
+        float* const opacityDecreaseRate = _opacityDecreaseRate.data() + blockStart;
+
+
+    #if defined(PARTICLE_SIMULATION_AVX2)
+
+        const __m256 deltaTime = _mm256_set1_ps(constants.DeltaTime);
+
+        const __m256 a = _mm256_loadu_ps(trajectoryA);
+        const __m256 b = _mm256_loadu_ps(trajectoryB);
+        __m256 x = _mm256_loadu_ps(trajectoryX);
+        const __m256 r = _mm256_loadu_ps(rate);
+        __m256 o = _mm256_loadu_ps(opacity);
+        const __m256 d = _mm256_loadu_ps(opacityDecreaseRate);
+
+        // Calculate next trajectory position
+        x = _mm256_add_ps(x, _mm256_mul_ps(r, deltaTime));
+        const __m256 y = _mm256_mul_ps(x, _mm256_sub_ps(b, _mm256_mul_ps(a, x)));
+
+        // Update opacity
+        o = _mm256_sub_ps(o, _mm256_mul_ps(d, deltaTime));
+
+        _mm256_store_ps(outputOpacities, o);
+
+
+        const __m256 ndcX = _mm256_mul_ps(x, _mm256_set1_ps(constants.CartesianToScaledNDCX));
+        const __m256 ndcY = _mm256_mul_ps(y, _mm256_set1_ps(constants.CartesianToScaledNDCY));
+
+        const __m256 screenX = _mm256_add_ps(_mm256_add_ps(_mm256_set1_ps(constants.Origin.x), _mm256_mul_ps(_mm256_set1_ps(constants.AxisX.x), ndcX)), _mm256_mul_ps(_mm256_set1_ps(constants.AxisY.x), ndcY));
+        const __m256 screenY = _mm256_add_ps(_mm256_add_ps(_mm256_set1_ps(constants.Origin.y), _mm256_mul_ps(_mm256_set1_ps(constants.AxisX.y), ndcX)), _mm256_mul_ps(_mm256_set1_ps(constants.AxisY.y), ndcY));
+
+        _mm256_store_ps(outputScreenPositionX, screenX);
+        _mm256_store_ps(outputScreenPositionY, screenY);
+
+
+        // If the particle is outside screen bounds, or has faded out..
+        const __m256 resetMask = _mm256_or_ps(_mm256_cmp_ps(screenY, _mm256_set1_ps(-1.0f), _CMP_LT_OQ),
+                                              _mm256_cmp_ps(o, _mm256_setzero_ps(), _CMP_LE_OQ));
+
+        const int resetLanes = _mm256_movemask_ps(resetMask);
+
+        _mm256_storeu_ps(trajectoryX, x);
+        _mm256_storeu_ps(opacity, o);
+
+    #elif defined(PARTICLE_SIMULATION_SSE)
+
+        const __m128 deltaTime = _mm_set1_ps(constants.DeltaTime);
+
+        const __m128 a = _mm_loadu_ps(trajectoryA);
+        const __m128 b = _mm_loadu_ps(trajectoryB);
+        __m128 x = _mm_loadu_ps(trajectoryX);
+        const __m128 r = _mm_loadu_ps(rate);
+        __m128 o = _mm_loadu_ps(opacity);
+        const __m128 d = _mm_loadu_ps(opacityDecreaseRate);
+
+        // Calculate next trajectory position
+        x = _mm_add_ps(x, _mm_mul_ps(r, deltaTime));
+        const __m128 y = _mm_mul_ps(x, _mm_sub_ps(b, _mm_mul_ps(a, x)));
+
+        // Update opacity
+        o = _mm_sub_ps(o, _mm_mul_ps(d, deltaTime));
+
+        _mm_store_ps(outputOpacities, o);
+
+
+        const __m128 ndcX = _mm_mul_ps(x, _mm_set1_ps(constants.CartesianToScaledNDCX));
+        const __m128 ndcY = _mm_mul_ps(y, _mm_set1_ps(constants.CartesianToScaledNDCY));
+
+        const __m128 screenX = _mm_add_ps(_mm_add_ps(_mm_set1_ps(constants.Origin.x), _mm_mul_ps(_mm_set1_ps(constants.AxisX.x), ndcX)), _mm_mul_ps(_mm_set1_ps(constants.AxisY.x), ndcY));
+        const __m128 screenY = _mm_add_ps(_mm_add_ps(_mm_set1_ps(constants.Origin.y), _mm_mul_ps(_mm_set1_ps(constants.AxisX.y), ndcX)), _mm_mul_ps(_mm_set1_ps(constants.AxisY.y), ndcY));
+
+        _mm_store_ps(outputScreenPositionX, screenX);
+        _mm_store_ps(outputScreenPositionY, screenY);
+
+
+        // If the particle is outside screen bounds, or has faded out..
+        const __m128 resetMask = _mm_or_ps(_mm_cmplt_ps(screenY, _mm_set1_ps(-1.0f)),
+                                           _mm_cmple_ps(o, _mm_setzero_ps()));
+
+        const int resetLanes = _mm_movemask_ps(resetMask);
+
+        _mm_storeu_ps(trajectoryX, x);
+        _mm_storeu_ps(opacity, o);
+
+    #else
+
+        // Calculate next trajectory position
+        trajectoryX[0] += rate[0] * constants.DeltaTime;
+        const float trajectoryY = ParticleTrajectoryFunction(trajectoryX[0], trajectoryA[0], trajectoryB[0]);
+
+        // Update opacity
+        opacity[0] -= opacityDecreaseRate[0] * constants.DeltaTime;
+
+        outputOpacities[0] = opacity[0];
+
+
+        const float ndcX = trajectoryX[0] * constants.CartesianToScaledNDCX;
+        const float ndcY = trajectoryY * constants.CartesianToScaledNDCY;
+
+        const glm::vec2 screenPosition = constants.Origin + (constants.AxisX * ndcX) + (constants.AxisY * ndcY);
+
+        outputScreenPositionX[0] = screenPosition.x;
+        outputScreenPositionY[0] = screenPosition.y;
+
+
+        // If the particle is outside screen bounds, or has faded out..
+        const int resetLanes = ((screenPosition.y < -1.0f) || (opacity[0] <= 0.0f)) ? 1 : 0;
+
+    #endif
+
+
+        // Every particle resets with values from its own random stream, and resets are rare, so they're done one particle at a time.
+        // A draining emitter's particles die instead
+        for(std::size_t lane = 0; lane < SimdWidth; lane++)
+        {
+            if((resetLanes & (1 << lane)) == 0)
+                continue;
+
+            if(constants.Draining == true)
+                opacity[lane] = 0.0f;
+            else
+                ResetParticle(blockStart + lane, constants.Behaviour, constants.Frame);
+        };
+    };
+
+};
\ No newline at end of file
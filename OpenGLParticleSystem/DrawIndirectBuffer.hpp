@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <glad/glad.h>
+
+
+/// <summary>
+/// The layout the API expects for a single indirect 'glDrawArrays*' command
+/// </summary>
+struct DrawArraysIndirectCommand
+{
+    /// <summary>
+    /// The number of vertices to draw
+    /// </summary>
+    std::uint32_t Count = 0;
+
+    std::uint32_t InstanceCount = 0;
+
+    /// <summary>
+    /// The first vertex
+    /// </summary>
+    std::uint32_t First = 0;
+
+    /// <summary>
+    /// An offset added to the instance index when fetching per-instance attributes
+    /// </summary>
+    std::uint32_t BaseInstance = 0;
+};
+
+
+/// <summary>
+/// A wrapper class for a GL_DRAW_INDIRECT_BUFFER of draw commands
+/// </summary>
+class DrawIndirectBuffer
+{
+
+private:
+
+    /// <summary>
+    /// An identifier used by the API
+    /// </summary>
+    std::uint32_t _bufferId = 0;
+
+    /// <summary>
+    /// The number of commands this buffer can hold
+    /// </summary>
+    std::uint32_t _numberOfCommands = 0;
+
+
+public:
+
+    /// <summary>
+    /// Create a buffer of empty commands
+    /// </summary>
+    /// <param name="numberOfCommands"></param>
+    DrawIndirectBuffer(const std::uint32_t numberOfCommands) :
+        _numberOfCommands(numberOfCommands)
+    {
+        const std::vector<DrawArraysIndirectCommand> commands = std::vector<DrawArraysIndirectCommand>(numberOfCommands);
+
+        glGenBuffers(1, &_bufferId);
+
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, _bufferId);
+
+        glBufferData(GL_DRAW_INDIRECT_BUFFER, sizeof(DrawArraysIndirectCommand) * numberOfCommands, commands.data(), GL_DYNAMIC_DRAW);
+    };
+
+
+    DrawIndirectBuffer(DrawIndirectBuffer&& other) noexcept :
+        _bufferId(other._bufferId),
+        _numberOfCommands(other._numberOfCommands)
+    {
+        other._bufferId = 0;
+    };
+
+    DrawIndirectBuffer(const DrawIndirectBuffer&) = delete;
+
+
+    ~DrawIndirectBuffer()
+    {
+        glDeleteBuffers(1, &_bufferId);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    };
+
+
+public:
+
+    void Bind() const
+    {
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, _bufferId);
+    };
+
+
+public:
+
+    std::uint32_t GetBufferID() const
+    {
+        return _bufferId;
+    };
+
+    std::uint32_t GetNumberOfCommands() const
+    {
+        return _numberOfCommands;
+    };
+
+
+public:
+
+    DrawIndirectBuffer& operator = (const DrawIndirectBuffer&) = delete;
+
+};
\ No newline at end of file
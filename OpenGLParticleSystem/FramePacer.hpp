@@ -0,0 +1,201 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <iostream>
+#include <glad/glad.h>
+
+
+/// <summary>
+/// Limits how many frames the CPU can submit before the GPU finishes them.
+/// Every frame gets a slot, and the fence placed at the end of a slot's frame is waited on before the slot is used again.
+/// Per-frame resources that the CPU writes, and the GPU reads, go through a StreamingBuffer with a region more than the frames in flight. 
+/// It fences its own regions, so a region that overflows mid-frame is retired without waiting for the pacer
+/// </summary>
+class FramePacer
+{
+
+public:
+
+    static constexpr std::uint32_t MinFramesInFlight = 1;
+    static constexpr std::uint32_t MaxFramesInFlight = 3;
+
+
+    /// <summary>
+    /// How long the CPU waited on a slot's fence
+    /// </summary>
+    struct WaitStatistics
+    {
+        std::chrono::duration<float, std::milli> TotalWaitTime = std::chrono::duration<float, std::milli>(0);
+
+        std::chrono::duration<float, std::milli> MaxWaitTime = std::chrono::duration<float, std::milli>(0);
+
+        /// <summary>
+        /// The number of frames that started on the slot
+        /// </summary>
+        std::uint32_t NumberOfFrames = 0;
+
+        /// <summary>
+        /// The number of frames that found the slot's fence unsignaled, and had to wait for it
+        /// </summary>
+        std::uint32_t NumberOfStalls = 0;
+    };
+
+
+private:
+
+    /// <summary>
+    /// The fence placed at the end of the last frame of every slot. Null if the slot's frame was never submitted, or was already waited on
+    /// </summary>
+    std::vector<GLsync> _slotFences;
+
+    /// <summary>
+    /// Wait statistics of every slot, since the last ResetStatistics()
+    /// </summary>
+    std::vector<WaitStatistics> _slotStatistics;
+
+    /// <summary>
+    /// The slot of the current frame
+    /// </summary>
+    std::uint32_t _currentSlot = 0;
+
+    /// <summary>
+    /// How long the current frame waited in BeginFrame()
+    /// </summary>
+    std::chrono::duration<float, std::milli> _lastWaitTime = std::chrono::duration<float, std::milli>(0);
+
+
+public:
+
+    FramePacer(const std::uint32_t framesInFlight) :
+        _slotFences(std::clamp(framesInFlight, MinFramesInFlight, MaxFramesInFlight), nullptr),
+        _slotStatistics(_slotFences.size())
+    {
+        if((framesInFlight < MinFramesInFlight) ||
+           (framesInFlight > MaxFramesInFlight))
+        {
+            std::cerr << "Frame pacer error: " << framesInFlight << " frames in flight is out of range, clamped to " << _slotFences.size() << "\n";
+            __debugbreak();
+        };
+    };
+
+    FramePacer(const FramePacer&) = delete;
+
+
+    ~FramePacer()
+    {
+        for(GLsync fence : _slotFences)
+        {
+            if(fence != nullptr)
+                glDeleteSync(fence);
+        };
+    };
+
+
+public:
+
+    /// <summary>
+    /// Wait until the GPU finished the last frame that used the current slot.
+    /// Must be called before anything of the frame is written or submitted
+    /// </summary>
+    void BeginFrame()
+    {
+        WaitStatistics& statistics = _slotStatistics[_currentSlot];
+
+        statistics.NumberOfFrames++;
+
+        _lastWaitTime = std::chrono::duration<float, std::milli>(0);
+
+
+        GLsync& fence = _slotFences[_currentSlot];
+
+        if(fence == nullptr)
+            return;
+
+        // Check without waiting first, so only actual stalls are timed
+        if(glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+        {
+            const std::chrono::steady_clock::time_point waitStart = std::chrono::steady_clock::now();
+
+            // The first wait flushes, so the fence is guaranteed to be signaled eventually
+            constexpr GLuint64 timeout = 1'000'000'000;
+
+            while(glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeout) == GL_TIMEOUT_EXPIRED);
+
+            _lastWaitTime = std::chrono::steady_clock::now() - waitStart;
+
+            statistics.TotalWaitTime += _lastWaitTime;
+            statistics.MaxWaitTime = std::max(statistics.MaxWaitTime, _lastWaitTime);
+            statistics.NumberOfStalls++;
+        };
+
+        glDeleteSync(fence);
+        fence = nullptr;
+    };
+
+
+    /// <summary>
+    /// Fence every command of the current frame, and move on to the next slot.
+    /// Must be called after the frame's last submission, usually right after the buffers are swapped
+    /// </summary>
+    void EndFrame()
+    {
+        _slotFences[_currentSlot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+        _currentSlot = (_currentSlot + 1) % GetFramesInFlight();
+    };
+
+
+    /// <summary>
+    /// Start counting every slot's wait time from zero
+    /// </summary>
+    void ResetStatistics()
+    {
+        std::fill(_slotStatistics.begin(), _slotStatistics.end(), WaitStatistics());
+    };
+
+
+public:
+
+    std::uint32_t GetFramesInFlight() const
+    {
+        return static_cast<std::uint32_t>(_slotFences.size());
+    };
+
+    std::chrono::duration<float, std::milli> GetLastWaitTime() const
+    {
+        return _lastWaitTime;
+    };
+
+    const WaitStatistics& GetSlotStatistics(const std::uint32_t slot) const
+    {
+        return _slotStatistics[slot];
+    };
+
+    /// <summary>
+    /// The statistics of every slot, added together
+    /// </summary>
+    /// <returns></returns>
+    WaitStatistics GetStatistics() const
+    {
+        WaitStatistics totalStatistics;
+
+        for(const WaitStatistics& statistics : _slotStatistics)
+        {
+            totalStatistics.TotalWaitTime += statistics.TotalWaitTime;
+            totalStatistics.MaxWaitTime = std::max(totalStatistics.MaxWaitTime, statistics.MaxWaitTime);
+            totalStatistics.NumberOfFrames += statistics.NumberOfFrames;
+            totalStatistics.NumberOfStalls += statistics.NumberOfStalls;
+        };
+
+        return totalStatistics;
+    };
+
+
+public:
+
+    FramePacer& operator = (const FramePacer&) = delete;
+
+};
\ No newline at end of file
@@ -6,6 +6,9 @@
 #include <glad/glad.h>
 #include <cassert>
 #include <iostream>
+#include <fstream>
+#include <string>
+#include <string_view>
 #include <stb_image.h>
 
 
@@ -116,6 +119,73 @@ namespace GLUtilities
     };
 
 
+    /// <summary>
+    /// Read all text inside a file
+    /// </summary>
+    /// <param name="filename"> Path to said file </param>
+    /// <returns></returns>
+    static std::string ReadAllText(const std::string& filename)
+    {
+        // Open the file at the end so we can easily find its length
+        std::ifstream fileStream = std::ifstream(filename, std::ios::ate);
+
+        std::string fileContents;
+
+        // Resize the buffer to fit content
+        fileContents.resize(fileStream.tellg());
+
+        fileStream.seekg(std::ios::beg);
+
+        // Read file contents into the buffer
+        fileStream.read(fileContents.data(), fileContents.size());
+
+        return fileContents;
+    };
+
+
+    /// <summary>
+    /// Read a shader's source, and replace every '#include "file"' line with the contents of said file. 
+    /// GLSL has no include directive of its own, this is how shaders share their definitions
+    /// </summary>
+    /// <param name="filename"></param>
+    /// <returns></returns>
+    static std::string ReadShaderSource(const std::string& filename)
+    {
+        if(std::ifstream(filename).is_open() == false)
+        {
+            std::cerr << "Shader error: Unable to open \"" << filename << "\"\n";
+            __debugbreak();
+        };
+
+        std::string source = ReadAllText(filename);
+
+        constexpr std::string_view includeDirective = "#include \"";
+
+        std::size_t includePosition = 0;
+
+        while((includePosition = source.find(includeDirective, includePosition)) != std::string::npos)
+        {
+            const std::size_t pathStart = includePosition + includeDirective.size();
+            const std::size_t pathEnd = source.find('"', pathStart);
+
+            if(pathEnd == std::string::npos)
+            {
+                std::cerr << "Shader error: Unterminated include in \"" << filename << "\"\n";
+                __debugbreak();
+            };
+
+            // Included files may include other files themselves
+            const std::string includedSource = ReadShaderSource(source.substr(pathStart, pathEnd - pathStart));
+
+            source.replace(includePosition, (pathEnd + 1) - includePosition, includedSource);
+
+            includePosition += includedSource.size();
+        };
+
+        return source;
+    };
+
+
     /// <summary>
     /// Convert a AccessType to a GL access enumeration.
     /// </summary>
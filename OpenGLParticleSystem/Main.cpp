@@ -6,13 +6,24 @@
 #include <random>
 #include <chrono>
 #include <array>
+#include <deque>
+#include <optional>
+#include <cstring>
 
-#include "VertexBuffer.hpp"
 #include "VertexArray.hpp"
-#include "BufferLayout.hpp"
+#include "VertexBuffer.hpp"
+#include "StreamingBuffer.hpp"
+#include "FramePacer.hpp"
+#include "AsyncBufferReadback.hpp"
 #include "ShaderProgram.hpp"
-#include "Texture.hpp"
+#include "ComputeShaderAutoTuner.hpp"
+#include "SpriteSheet.hpp"
+#include "TextureCache.hpp"
+#include "AsyncSpriteLoader.hpp"
+#include "ParticleSystem.hpp"
 #include "ParticleEmitter.hpp"
+#include "ParticleEmitterPool.hpp"
+#include "CpuParticleSimulation.hpp"
 
 
 
@@ -58,7 +69,7 @@ GLFWwindow* InitializeGLFWWindow(int windowWidth, int windowHeight, std::string_
     glfwSetErrorCallback(GLFWErrorCallback);
 
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 4);
 
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
@@ -126,6 +137,185 @@ void SetupOpenGL()
 };
 
 
+/// <summary>
+/// Compare the results of the CPU simulation with the results of an emitter's compute shader
+/// </summary>
+/// <param name="cpuSimulation"> A CPU simulation that was stepped with the same input as the emitter </param>
+/// <param name="particleSystem"> The particle system that stores the emitter's particles </param>
+/// <param name="particleEmmiter"> An emitter that was already updated </param>
+void ValidateCpuSimulation(const CpuParticleSimulation& cpuSimulation, const ParticleSystem& particleSystem, const ParticleEmmiter& particleEmmiter)
+{
+    // The GPU and CPU don't round exactly the same way
+    constexpr float tolerance = 1e-3f;
+
+    const std::uint32_t numberOfParticles = particleEmmiter.GetNumberOfParticles();
+
+
+    std::vector<glm::vec4> gpuInstances = std::vector<glm::vec4>(numberOfParticles);
+
+    particleSystem.GetOutputParticleInstancesBuffer().GetBuffer(gpuInstances.data(), numberOfParticles, particleEmmiter.GetFirstParticle());
+
+
+    float maxPositionError = 0.0f;
+    float maxScaleError = 0.0f;
+    float maxOpacityError = 0.0f;
+
+    for(std::size_t i = 0; i < numberOfParticles; i++)
+    {
+        const glm::vec4 error = glm::abs(cpuSimulation.GetInstances()[i] - gpuInstances[i]);
+
+        maxPositionError = std::max({ maxPositionError, error.x, error.y });
+        maxScaleError = std::max(maxScaleError, error.z);
+        maxOpacityError = std::max(maxOpacityError, error.w);
+    };
+
+
+    if((maxPositionError > tolerance) ||
+       (maxScaleError > tolerance) ||
+       (maxOpacityError > tolerance))
+    {
+        std::cerr << "CPU simulation (" << CpuParticleSimulation::GetSimdPathName() << ") mismatch: "
+            << "Position error: " << maxPositionError << ", "
+            << "Scale error: " << maxScaleError << ", "
+            << "Opacity error: " << maxOpacityError << "\n";
+        __debugbreak();
+    };
+};
+
+
+/// <summary>
+/// Step the CPU simulation without a window or a GL context, and print how long it took.
+/// Every particle belongs to a single emitter in the middle of the screen
+/// </summary>
+/// <param name="numberOfParticles"></param>
+/// <param name="numberOfFrames"></param>
+/// <param name="particleScaleFactor"></param>
+void RunHeadlessCpuSimulation(const std::uint32_t numberOfParticles, const std::uint32_t numberOfFrames, const float particleScaleFactor)
+{
+    // A fixed time step, and window size, so runs can be compared with each other
+    constexpr float deltaTime = 1.0f / 60.0f;
+
+    constexpr float windowWidth = 800.0f;
+    constexpr float windowHeight = 600.0f;
+
+
+    const glm::mat4 particleTransfrom = glm::scale(glm::mat4(1.0f), { particleScaleFactor, particleScaleFactor, particleScaleFactor });
+
+    const EmitterParameters emitterParameters = EmitterParameters::FromTransforms(particleTransfrom, particleTransfrom, std::random_device {}());
+
+
+    CpuParticleSimulation cpuSimulation = CpuParticleSimulation(numberOfParticles);
+
+    cpuSimulation.Initialize(emitterParameters, 0, 0, 0);
+
+
+    const std::chrono::steady_clock::time_point simulationStart = std::chrono::steady_clock::now();
+
+    for(std::uint32_t frame = 0; frame < numberOfFrames; frame++)
+    {
+        cpuSimulation.Step(deltaTime, emitterParameters, windowWidth, windowHeight, particleScaleFactor, frame);
+    };
+
+    const std::chrono::duration<float, std::milli> simulationTime = std::chrono::steady_clock::now() - simulationStart;
+
+
+    std::cout << "Headless CPU simulation (" << CpuParticleSimulation::GetSimdPathName() << "), " << numberOfParticles << " particles, " << numberOfFrames << " frames: "
+        << simulationTime.count() << "ms, " << (simulationTime.count() / numberOfFrames) << "ms/frame\n";
+};
+
+
+/// <summary>
+/// Compare the particles an async readback returned with the particles glGetBufferSubData returned for the same request
+/// </summary>
+/// <param name="readback"> A readback whose data arrived </param>
+/// <param name="expectedParticles"> The particles read synchronously right after the readback was requested </param>
+void ValidateAsyncReadback(const AsyncBufferReadback& readback, const std::vector<ComputeShaderParticle>& expectedParticles)
+{
+    const std::size_t expectedSizeInBytes = expectedParticles.size() * sizeof(ComputeShaderParticle);
+
+    if((readback.GetSizeInBytes() != expectedSizeInBytes) ||
+       (std::memcmp(readback.GetData<ComputeShaderParticle>(), expectedParticles.data(), expectedSizeInBytes) != 0))
+    {
+        std::cerr << "Async readback mismatch: " << readback.GetSizeInBytes() << " bytes read asynchronously, " << expectedSizeInBytes << " bytes expected\n";
+        __debugbreak();
+    };
+};
+
+
+/// <summary>
+/// Time per-frame CPU writes, the way emitter parameters are written, through VertexBuffer::MapBuffer and through a StreamingBuffer.
+/// Every write is copied to another buffer on the GPU, so both paths have to deal with the GPU still reading earlier writes
+/// </summary>
+/// <param name="numberOfFrames"></param>
+/// <param name="writesPerFrame"></param>
+void BenchmarkStreamingWrites(const std::uint32_t numberOfFrames, const std::uint32_t writesPerFrame)
+{
+    constexpr std::size_t writeSizeInBytes = sizeof(EmitterParameters);
+
+    const std::size_t frameSizeInBytes = writeSizeInBytes * writesPerFrame;
+
+    const EmitterParameters writeData = EmitterParameters::FromTransforms(glm::mat4(1.0f), glm::mat4(1.0f), 0);
+
+    VertexBuffer destinationBuffer = VertexBuffer(nullptr, frameSizeInBytes, GL_DYNAMIC_COPY);
+
+
+    // Map, write, and unmap, a buffer for every write
+    VertexBuffer mappedBuffer = VertexBuffer(nullptr, writeSizeInBytes, GL_STREAM_DRAW);
+
+    glFinish();
+
+    const std::chrono::steady_clock::time_point mapStart = std::chrono::steady_clock::now();
+
+    for(std::uint32_t frame = 0; frame < numberOfFrames; frame++)
+    {
+        for(std::uint32_t i = 0; i < writesPerFrame; i++)
+        {
+            {
+                auto buffer = mappedBuffer.MapBuffer<EmitterParameters>(GL::AccessType::WriteOnly);
+
+                *buffer = writeData;
+            };
+
+            glBindBuffer(GL_COPY_READ_BUFFER, mappedBuffer.GetID());
+            glBindBuffer(GL_COPY_WRITE_BUFFER, destinationBuffer.GetID());
+
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, writeSizeInBytes * i, writeSizeInBytes);
+        };
+    };
+
+    glFinish();
+
+    const std::chrono::duration<float, std::milli> mapTime = std::chrono::steady_clock::now() - mapStart;
+
+
+    // Write into the current region of a persistently mapped buffer
+    StreamingBuffer streamingBuffer = StreamingBuffer(frameSizeInBytes);
+
+    const std::chrono::steady_clock::time_point streamingStart = std::chrono::steady_clock::now();
+
+    for(std::uint32_t frame = 0; frame < numberOfFrames; frame++)
+    {
+        for(std::uint32_t i = 0; i < writesPerFrame; i++)
+        {
+            const std::size_t streamingOffset = streamingBuffer.Write(&writeData, writeSizeInBytes);
+
+            streamingBuffer.CopyTo(streamingOffset, destinationBuffer.GetID(), writeSizeInBytes * i, writeSizeInBytes);
+        };
+
+        streamingBuffer.NextFrame();
+    };
+
+    glFinish();
+
+    const std::chrono::duration<float, std::milli> streamingTime = std::chrono::steady_clock::now() - streamingStart;
+
+
+    std::cout << "Streaming writes benchmark, " << numberOfFrames << " frames of " << writesPerFrame << " writes:\n"
+        << "    MapBuffer: " << mapTime.count() << "ms\n"
+        << "    StreamingBuffer (" << streamingBuffer.GetNumberOfRegions() << " regions): " << streamingTime.count() << "ms, " << streamingBuffer.GetNumberOfStalls() << " stalls\n";
+};
+
+
 int main()
 {
     
@@ -135,9 +325,78 @@ int main()
     constexpr bool generateEmitters = true;
     constexpr std::uint32_t emittersToGenerate = 700;
 
+    // Every frame, destroy this many of the oldest emitters and create as many new ones in random positions
+    constexpr std::uint32_t emittersToRespawnPerFrame = 0;
+
 
     constexpr std::uint32_t particlesPerEmitter = 250;
 
+    // Particles are scaled down by this, both on the GPU and by the CPU simulation
+    constexpr float particleScaleFactor = 0.05f;
+
+    // The particle system reserves storage for this many emitters up front
+    constexpr std::uint32_t maxNumberOfEmitters = 1000;
+
+    // Update and draw every emitter with a single dispatch and draw call, instead of one per emitter
+    constexpr bool batchEmitters = true;
+
+    // When batching, draw with one indirect command per emitter instead of one draw call over every particle
+    constexpr bool multiDrawIndirect = true;
+
+    // Run the CPU simulation alongside the first emitter, and compare it with the compute shader's results every frame
+    constexpr bool validateCpuSimulation = false;
+
+    // Step the CPU simulation on its own, before any window or GL context is created, then exit. 
+    // Not limited by what the particle system reserves, it simulates past the particles the GPU path spawns
+    constexpr bool headlessCpuSimulation = false;
+    constexpr std::uint32_t headlessSimulationParticles = 2'000'000;
+    constexpr std::uint32_t headlessSimulationFrames = 600;
+
+    // How many frames the CPU may run ahead of the GPU, between 1 and 3. 
+    // 1 waits for every frame to finish before starting the next, more frames overlap CPU submission with GPU work at the cost of latency
+    constexpr std::uint32_t framesInFlight = 2;
+
+    // Time variants of the transform compute shader once the emitters are generated, and update particles with the fastest one
+    constexpr bool autoTuneComputeShader = false;
+
+    // Compare VertexBuffer::MapBuffer with the streaming buffer before starting
+    constexpr bool benchmarkStreamingWrites = false;
+
+    // Read the first emitter's particles back asynchronously, and compare them with a synchronous read of the same frame once they arrive
+    constexpr bool validateAsyncReadback = false;
+
+    // Give every generated emitter its own spawn ranges, direction, and sprite. They're still updated with a single dispatch
+    constexpr bool varyEmitterBehaviours = false;
+
+    // Sway every emitter sideways every frame. The parameters of every emitter change, and are still uploaded with a single copy
+    constexpr bool moveEmitters = false;
+
+    // Load the sprites from a cooked texture cache, if it was cooked from the current sprites. Otherwise the PNGs are decoded like before
+    constexpr bool loadSpriteCache = true;
+
+    // The offline cook step: decode, mipmap, and compress the sprites into the texture cache, then exit. Run it whenever the sprites change
+    constexpr bool cookSpriteCache = false;
+
+    // Compress cooked sprites to BC3, a quarter of RGBA8's texture memory
+    constexpr bool compressSpriteCache = true;
+
+    constexpr const char* spriteCachePath = "Resources/Sprites.texcache";
+
+    // If the sprites aren't loaded from the cache, decode them on worker threads and upload them over the first frames, instead of before the first frame.
+    // Sprites draw transparent until they're uploaded
+    constexpr bool loadSpritesAsynchronously = true;
+
+    // Decode the sprites again once the particle system reaches this frame, with a new AsyncSpriteLoader whose sheet the particle system switches to right away, 
+    // the way a sprite set loaded mid-session would be. Its sprites draw transparent until they're uploaded. 0 never reloads
+    constexpr std::uint32_t reloadSpritesOnFrame = 0;
+
+
+    if constexpr(headlessCpuSimulation == true)
+    {
+        RunHeadlessCpuSimulation(headlessSimulationParticles, headlessSimulationFrames, particleScaleFactor);
+        return 0;
+    };
+
 
     // Create a window
     GLFWwindow* glfwWindow = InitializeGLFWWindow(initialWindowWidth, initialWindowHeight,
@@ -149,119 +408,166 @@ int main()
     SetupOpenGL();
 
 
-    // The main VAO that will be used by the particle emmiter
-    VertexArray particleVAO = VertexArray();
-
-
-    // Particle vertex position, along with texture coordinates
-    constexpr float vertexPositions[] =
+    if constexpr(benchmarkStreamingWrites == true)
     {
-        // Bottom left
-        -1.0f, -1.0f,  0.0f, 0.0f,
-        // Bottom right
-        1.0f,  -1.0f,  1.0f, 0.0f,
-        // Top right
-        1.0f,   1.0f,  1.0f, 1.0f,
-
-        // Top right
-        1.0f,   1.0f,  1.0f, 1.0f,
-        // Top left
-        -1.0f,  1.0f,  0.0f, 1.0f,
-        // Bottom left
-        -1.0f, -1.0f,  0.0f, 0.0f,
+        BenchmarkStreamingWrites(100, maxNumberOfEmitters);
     };
 
 
+    // The main VAO that will be used by the particle emmiter. 
+    // It stays empty, the vertex shader pulls the particles' quads and instances by gl_VertexID
+    VertexArray particleVAO = VertexArray();
 
-    // vertex positions VBO
-    VertexBuffer vertexPositionVBO = VertexBuffer(&vertexPositions, sizeof(vertexPositions));
 
-    BufferLayout vertexPositionBufferlayout;
 
+    // Particle transforms
+    const glm::mat4 particleTransfrom = glm::scale(glm::mat4(1.0f), { particleScaleFactor, particleScaleFactor, particleScaleFactor });
 
-    // Vertex position
-    vertexPositionBufferlayout.AddElement<float>(0, 2);
 
-    // Texture coordinate
-    vertexPositionBufferlayout.AddElement<float>(1, 2);
 
-    particleVAO.AddBuffer(vertexPositionVBO, vertexPositionBufferlayout);
 
+    // Keeps the CPU at most framesInFlight frames ahead of the GPU. 
+    // Clamps framesInFlight to what it supports, the per-frame resources below are sized by its count
+    FramePacer framePacer = FramePacer(framesInFlight);
 
 
-    // Particle opacity
-    VertexBuffer opacityVBO = VertexBuffer(nullptr, sizeof(float) * particlesPerEmitter, GL_DYNAMIC_DRAW);
+    // Every PNG in Resources, one per layer of a single texture array
+    const std::vector<std::string> spritePaths = SpriteSheet::FindSprites("Resources");
 
+    // FindSprites() already reported it. Every emitter draws a sprite, so there's nothing to run without any
+    if(spritePaths.empty() == true)
+    {
+        glfwDestroyWindow(glfwWindow);
+        return 1;
+    };
 
-    BufferLayout opacityBufferLayout;
+    if constexpr(cookSpriteCache == true)
+    {
+        const bool cooked = TextureCache::Cook(spritePaths, spriteCachePath, compressSpriteCache);
+
+        std::cout << (cooked ? "Cooked " : "Failed to cook ") << spritePaths.size() << " sprites into \"" << spriteCachePath << "\"\n";
 
-    opacityBufferLayout.AddElement<float>(2, 1, 1);
+        glfwDestroyWindow(glfwWindow);
+        return 0;
+    };
 
-    particleVAO.AddBuffer(opacityVBO, opacityBufferLayout);
+    const std::chrono::steady_clock::time_point spritesLoadStart = std::chrono::steady_clock::now();
 
+    std::optional<SpriteSheet> loadedSprites = loadSpriteCache ? TextureCache::Load(spritePaths, spriteCachePath) : std::nullopt;
 
+    if((loadSpriteCache == true) &&
+       (loadedSprites.has_value() == false))
+        std::cerr << "Texture cache \"" << spriteCachePath << "\" is stale, decoding sprites instead\n";
 
-    std::array<std::uint32_t, particlesPerEmitter> textureUnitBuffer;
+    // Decodes the sprites in the background, if they weren't loaded from the cache
+    std::optional<AsyncSpriteLoader> spriteLoader;
 
-    for(std::size_t i = 0; i < textureUnitBuffer.size(); i++)
+    if(loadedSprites.has_value() == false)
     {
-        textureUnitBuffer[i] = i % 3;
+        if constexpr(loadSpritesAsynchronously == true)
+            spriteLoader.emplace(spritePaths, 0, 4 * 1024 * 1024, framePacer.GetFramesInFlight());
+        else
+            loadedSprites.emplace(SpriteSheet::PackFiles(spritePaths));
     };
 
+    const SpriteSheet& particleSprites = loadedSprites.has_value() ? loadedSprites.value() : spriteLoader->GetSpriteSheet();
 
-    // Particle texture units
-    VertexBuffer particleTextureUnits = VertexBuffer(textureUnitBuffer.data(), sizeof(textureUnitBuffer));
+    // Wait for the uploads, so they're included in the timing
+    glFinish();
 
-    BufferLayout particleTextureUnitsBufferLayout;
+    const std::chrono::duration<float, std::milli> spritesLoadTime = std::chrono::steady_clock::now() - spritesLoadStart;
 
-    particleTextureUnitsBufferLayout.AddElement<std::uint32_t>(3, 1, 1);
+    if(spriteLoader.has_value() == true)
+        std::cout << "Decoding " << particleSprites.GetNumberOfSprites() << " sprites on " << spriteLoader->GetNumberOfWorkers() << " threads, started in " << spritesLoadTime.count() << "ms\n";
+    else
+        std::cout << "Loaded " << particleSprites.GetNumberOfSprites() << " sprites (" << particleSprites.GetTextureArray().GetSizeInBytes() / 1024.0f << " KB of texture memory) in " << spritesLoadTime.count() << "ms\n";
 
-    particleVAO.AddBuffer(particleTextureUnits, particleTextureUnitsBufferLayout);
 
+    // A shader program that will be used by the Particle emitter
+    const ShaderProgram texturedShaderProgram = ShaderProgram("ParticleVertexShader.glsl", "ParticleFragmentShader.glsl");
 
+    const ComputeShaderProgram computeShader = ComputeShaderProgram("ParticleTransformShader.glsl");
 
-    // Particle transforms
-    constexpr float particleScaleFactor = 0.05f;
+    // Owns the variants of the transform compute shader, the particle system may end up using one of them
+    ComputeShaderAutoTuner computeShaderTuner = ComputeShaderAutoTuner("ParticleTransformShader.glsl", "WORK_GROUP_SIZE", "PARTICLES_PER_INVOCATION");
 
-    const glm::mat4 particleTransfrom = glm::scale(glm::mat4(1.0f), { particleScaleFactor, particleScaleFactor, particleScaleFactor });
+    const ComputeShaderProgram seedShader = ComputeShaderProgram("ParticleSeedShader.glsl");
 
-    VertexBuffer transformVBO = VertexBuffer(nullptr, sizeof(particleTransfrom) * particlesPerEmitter, GL_DYNAMIC_DRAW);
 
-    BufferLayout transformBufferlayout;
+    // Stores the particles of every emitter, also sets up the per-instance opacity and transform attributes
+    ParticleSystem particleSystem = ParticleSystem(maxNumberOfEmitters,
+                                                   particlesPerEmitter,
+                                                   particleScaleFactor,
+                                                   framePacer.GetFramesInFlight(),
+                                                   texturedShaderProgram,
+                                                   computeShader,
+                                                   seedShader,
+                                                   particleVAO,
+                                                   particleSprites);
 
-    transformBufferlayout.AddElement<float>(4, 4, 1);
-    transformBufferlayout.AddElement<float>(5, 4, 1);
-    transformBufferlayout.AddElement<float>(6, 4, 1);
-    transformBufferlayout.AddElement<float>(7, 4, 1);
 
-    particleVAO.AddBuffer(transformVBO, transformBufferlayout);
 
+    // Every particle emitter lives in the pool, and is referred to by its handle
+    ParticleEmitterPool particleEmitterPool = ParticleEmitterPool(particleSystem);
 
+    // Handles of the emitters, oldest first. 
+    // Handles of destroyed emitters aren't searched for, they're dropped once they reach the front
+    std::deque<ParticleEmitterHandle> particleEmitterHandles;
+
+    // Drop the handles of destroyed emitters from the front, so the front is the oldest live emitter
+    const auto pruneEmitterHandles = [&]()
+    {
+        while((particleEmitterHandles.empty() == false) &&
+              (particleEmitterPool.IsValid(particleEmitterHandles.front()) == false))
+            particleEmitterHandles.pop_front();
+    };
 
 
-    const Texture particleTexture1 = Texture("Resources\\Particle1.png");
-    const Texture particleTexture2 = Texture("Resources\\Particle2.png");
-    const Texture particleTexture3 = Texture("Resources\\Particle3.png");
+    std::mt19937 rng = std::mt19937(std::random_device {}());
 
+    const std::uniform_int_distribution particleXDistribution = std::uniform_int_distribution(0, WindowWidth);
+    const std::uniform_int_distribution particleYDistribution = std::uniform_int_distribution(0, WindowHeight);
 
+    const std::uniform_real_distribution spawnRangeScaleDistribution = std::uniform_real_distribution(0.5f, 1.5f);
+    const std::uniform_int_distribution directionDistribution = std::uniform_int_distribution(0, 2);
+    const std::uniform_int_distribution spriteDistribution = std::uniform_int_distribution<std::uint32_t>(0, particleSprites.GetNumberOfSprites() - 1);
 
-    const std::vector<const Texture*> particleTextures =
+    // Add a new particle emitter in a random position
+    const auto createRandomEmitter = [&]()
     {
-        &particleTexture1,
-        &particleTexture2,
-        &particleTexture3,
-    };
+        const auto emitterPosition = ScreenToNDC({ particleXDistribution(rng), particleYDistribution(rng) }) / particleScaleFactor;
 
+        particleEmitterHandles.push_back(particleEmitterPool.Create(glm::translate(particleTransfrom, { emitterPosition.x, emitterPosition.y, 0 })));
 
-    // A shader program that will be used by the Particle emitter
-    const ShaderProgram texturedShaderProgram = ShaderProgram("ParticleVertexShader.glsl", "ParticleFragmentShader.glsl");
+        if constexpr(varyEmitterBehaviours == true)
+        {
+            EmitterBehaviour behaviour;
 
-    const ComputeShaderProgram computeShader = ComputeShaderProgram("ParticleTransformShader.glsl");
+            behaviour.TrajectoryBRange *= spawnRangeScaleDistribution(rng);
+            behaviour.RateRange *= spawnRangeScaleDistribution(rng);
+            behaviour.OpacityDecreaseRateRange *= spawnRangeScaleDistribution(rng);
+
+            // Alternating, every particle left, or every particle right
+            constexpr std::uint32_t directionFlags[] = { EmitterBehaviour::AlternateDirectionsFlag, EmitterBehaviour::LeftDirectionFlag, 0 };
+
+            behaviour.Flags = directionFlags[directionDistribution(rng)];
 
+            SpriteHandle sprite = { spriteDistribution(rng) };
 
+            // While sprites are loading, prefer one that was already uploaded, so the emitter doesn't start out invisible
+            if((spriteLoader.has_value() == true) &&
+               (spriteLoader->GetNumberOfReadySprites() > 0))
+            {
+                while(spriteLoader->IsReady(sprite) == false)
+                    sprite = spriteLoader->GetSprite((sprite.Layer + 1) % spriteLoader->GetNumberOfSprites());
+            };
 
-    // A list of particle emmiters
-    std::vector<ParticleEmmiter> particleEmmiters = std::vector<ParticleEmmiter>();
+            behaviour.FirstSprite = sprite.Layer;
+            behaviour.NumberOfSprites = 1;
+
+            particleEmitterPool.Get(particleEmitterHandles.back()).SetBehaviour(behaviour);
+        };
+    };
 
 
 
@@ -272,58 +578,65 @@ int main()
         {
             const auto mouseNDC = MouseToNDC() / particleScaleFactor;
 
-            particleEmmiters.emplace_back(particlesPerEmitter,
-                                          particleScaleFactor,
-                                          // Translate the original particle transform to Mouse position
-                                          glm::translate(particleTransfrom, { mouseNDC.x, mouseNDC.y, 0 }),
-                                          texturedShaderProgram,
-                                          particleVAO,
-                                          particleTextures,
-                                          vertexPositionVBO,
-                                          transformVBO,
-                                          opacityVBO,
-                                          computeShader);
+            // Translate the original particle transform to Mouse position
+            particleEmitterHandles.push_back(particleEmitterPool.Create(glm::translate(particleTransfrom, { mouseNDC.x, mouseNDC.y, 0 })));
         };
 
 
-        // Destory all particle emitters
+        // Destory all particle emitters. They're removed from the pool once their particles fade out
         rightMouseButtonClickedCallback = [&]()
         {
-            if(particleEmmiters.empty() == true)
-                return;
-
-            particleEmmiters.erase(particleEmmiters.end() - 1);
-
-            /*
-            for(ParticleEmmiter& particleEmmiter : particleEmmiters)
+            particleEmitterPool.ForEach([](ParticleEmitterHandle, ParticleEmmiter& particleEmmiter)
             {
                 particleEmmiter.Destory();
-            };
-            */
+            });
         };
 
     }
     else if constexpr(generateEmitters == true)
     {
-        std::mt19937 rng = std::mt19937(std::random_device {}());
-
-        const std::uniform_int_distribution particleXDistribution = std::uniform_int_distribution(0, WindowWidth);
-        const std::uniform_int_distribution particleYDistribution = std::uniform_int_distribution(0, WindowHeight);
+        const std::chrono::steady_clock::time_point generationStart = std::chrono::steady_clock::now();
 
         for(std::size_t i = 0; i < emittersToGenerate; i++)
         {
-            const auto emitterPosition = ScreenToNDC({ particleXDistribution(rng), particleYDistribution(rng) }) / particleScaleFactor;
-
-            particleEmmiters.emplace_back(particlesPerEmitter,
-                                          particleScaleFactor,
-                                          glm::translate(particleTransfrom, { emitterPosition.x, emitterPosition.y, 0 }),
-                                          texturedShaderProgram,
-                                          particleVAO,
-                                          particleTextures,
-                                          vertexPositionVBO,
-                                          transformVBO,
-                                          opacityVBO,
-                                          computeShader);
+            createRandomEmitter();
+        };
+
+        particleSystem.FlushPendingParticles();
+
+        // Wait for the GPU to finish seeding, so it's included in the timing
+        glFinish();
+
+        const std::chrono::duration<float, std::milli> generationTime = std::chrono::steady_clock::now() - generationStart;
+
+        std::cout << "Generated " << emittersToGenerate << " emitters (" << emittersToGenerate * particlesPerEmitter << " particles) in " << generationTime.count() << "ms\n";
+    };
+
+
+    if constexpr(autoTuneComputeShader == true)
+    {
+        const std::uint32_t numberOfParticles = particleSystem.GetNumberOfParticles();
+
+        // Variants are timed updating every particle there is, with no time step, so the particles are left as they were
+        if(numberOfParticles > 0)
+        {
+            const ComputeShaderProgram& fastestComputeShader = computeShaderTuner.Tune({ 32, 64, 128, 256 }, { 1, 2, 4 }, [&](const ComputeShaderProgram& computeShaderVariant)
+            {
+                // Validates the variant and looks its uniforms up, which must not be timed
+                particleSystem.SetComputeShaderProgram(computeShaderVariant);
+                particleSystem.Bind();
+            },
+            [&](const ComputeShaderProgram&)
+            {
+                particleSystem.UpdateRange(0.0f, 0, numberOfParticles);
+            }, 20);
+
+            computeShaderTuner.PrintResults();
+
+            particleSystem.SetComputeShaderProgram(fastestComputeShader);
+
+            // The timed updates are a valid frame
+            particleSystem.SwapParticleBuffers();
         };
     };
 
@@ -347,44 +660,221 @@ int main()
     constexpr auto fpsDisplayInterval = std::chrono::milliseconds(700);
 
 
+    // How far, in scaled NDC, emitters sway to either side
+    constexpr float emitterSwayDistance = 4.0f;
+
+    float emitterSwayTime = 0.0f;
+
+
+    CpuParticleSimulation cpuSimulation = CpuParticleSimulation(particlesPerEmitter);
+
+    std::vector<ComputeShaderParticle> cpuSimulationInput = std::vector<ComputeShaderParticle>(particlesPerEmitter);
+
+
+    AsyncBufferReadback asyncReadback = AsyncBufferReadback(sizeof(ComputeShaderParticle) * particlesPerEmitter);
+
+    std::vector<ComputeShaderParticle> asyncReadbackExpected;
+
+    std::uint32_t asyncReadbackRequestFrame = 0;
+
+    bool asyncReadbackLatencyPrinted = false;
+
+
+    bool spritesReloaded = false;
+
+
     while(glfwWindowShouldClose(glfwWindow) == false)
     {
         timePoint1 = std::chrono::steady_clock::now();
 
+        // Wait for the GPU to finish the frame that last used this frame's slot
+        framePacer.BeginFrame();
+
         glfwPollEvents();
 
         glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
 
-        // Bind, update, and draw, particles
-        auto iterator = particleEmmiters.begin();
+        if constexpr(reloadSpritesOnFrame > 0)
+        {
+            if((spritesReloaded == false) &&
+               (particleSystem.GetFrame() >= reloadSpritesOnFrame))
+            {
+                // The previous loader, and the sheet the particle system draws with, go first. Nothing is drawn before the particle system gets the new sheet
+                spriteLoader.reset();
+                spriteLoader.emplace(spritePaths, 0, 4 * 1024 * 1024, framePacer.GetFramesInFlight());
+
+                // Bound with the rest of the particle system's state below
+                particleSystem.SetSpriteSheet(spriteLoader->GetSpriteSheet());
 
-        while(iterator != particleEmmiters.cend())
+                spritesReloaded = true;
+            };
+        };
+
+
+        // Upload the sprites that finished decoding since the last frame
+        if((spriteLoader.has_value() == true) &&
+           (spriteLoader->IsFinished() == false))
         {
-            ParticleEmmiter& particleEmmiter = *iterator;
+            spriteLoader->Update();
+
+            if(spriteLoader->IsFinished() == true)
+                std::cout << "Loaded " << spriteLoader->GetNumberOfSprites() << " sprites asynchronously in " << spriteLoader->GetLoadTime().count() << "ms\n";
+        };
+
 
+        // Replace the oldest emitters, their particle ranges are recycled by the new ones
+        if constexpr(emittersToRespawnPerFrame > 0)
+        {
+            for(std::uint32_t i = 0; i < emittersToRespawnPerFrame; i++)
+            {
+                pruneEmitterHandles();
+
+                if(particleEmitterHandles.empty() == true)
+                    break;
+
+                particleEmitterPool.Destroy(particleEmitterHandles.front());
+                particleEmitterHandles.pop_front();
+
+                createRandomEmitter();
+            };
+
+            pruneEmitterHandles();
+        };
+
+
+        if constexpr(moveEmitters == true)
+        {
+            // The sway's offset is a sine, so every frame moves emitters by the change in the sine
+            const float previousSway = std::sin(emitterSwayTime) * emitterSwayDistance;
+
+            emitterSwayTime += delta.count();
+
+            const float sway = (std::sin(emitterSwayTime) * emitterSwayDistance) - previousSway;
+
+            particleEmitterPool.ForEach([sway](const ParticleEmitterHandle, ParticleEmmiter& particleEmmiter)
+            {
+                particleEmmiter.SetParticleEmmiterTransform(glm::translate(particleEmmiter.GetParticleEmmiterTransform(), { sway, 0.0f, 0.0f }));
+            });
+        };
+
+
+        // Step the CPU simulation with the same input the first emitter's compute shader is about to get
+        if constexpr(validateCpuSimulation == true)
+        {
+            if(particleEmitterHandles.empty() == false)
+            {
+                ParticleEmmiter& particleEmmiter = particleEmitterPool.Get(particleEmitterHandles.front());
+
+                // The emitter might have been created this frame, and its particles may be moved before the update
+                particleSystem.CompactIfRequested();
+                particleSystem.FlushPendingParticles();
+
+                particleSystem.GetInputParticleBuffer().GetBuffer(cpuSimulationInput.data(), particlesPerEmitter, particleEmmiter.GetFirstParticle());
+
+                cpuSimulation.Load(cpuSimulationInput.data(), particleEmmiter.GetFirstParticle(), particleEmmiter.GetSeed());
+                cpuSimulation.Step(delta.count(), particleEmmiter.GetEmitterParameters(), static_cast<float>(WindowWidth), static_cast<float>(WindowHeight), particleScaleFactor, particleSystem.GetFrame());
+            };
+        };
+
+
+        // Every emitter shares the particle system's state, so it's bound once for all of them
+        if constexpr(batchEmitters == false)
+            particleSystem.Bind();
+
+        // Update, and draw, particles
+        particleEmitterPool.ForEach([&](const ParticleEmitterHandle handle, ParticleEmmiter& particleEmmiter)
+        {
             // If an emitter was destroyed...
             if(particleEmmiter.GetDestroyed() == true)
             {
-                // Remove from emitters list, and update iterator
-                iterator = particleEmmiters.erase(iterator);
-                continue;
+                // Remove it from the pool. Its handle is dropped from the handles list once it's the oldest
+                particleEmitterPool.Destroy(handle);
+                return;
             };
 
-            particleEmmiter.Bind();
-            particleEmmiter.Update(delta.count());
+            // When batching, every emitter is updated and drawn at once after the loop
+            if constexpr(batchEmitters == false)
+            {
+                particleEmmiter.Update(delta.count());
+            };
+        });
+
+        pruneEmitterHandles();
+
+
+        if constexpr(batchEmitters == true)
+        {
+            particleSystem.Bind();
+            particleSystem.Update(delta.count());
+
+            if constexpr(multiDrawIndirect == true)
+                particleSystem.DrawIndirect();
+            else
+                particleSystem.Draw();
+        }
+        else
+        {
+            // Every emitter was updated, so this frame's output becomes the next frame's input. 
+            // The updates share the barrier placed here, so emitters are only drawn after all of them were updated
+            particleSystem.SwapParticleBuffers();
+
+            particleEmitterPool.ForEach([](const ParticleEmitterHandle, ParticleEmmiter& particleEmmiter)
+            {
+                particleEmmiter.Draw();
+            });
+        };
+
+
+        if constexpr(validateCpuSimulation == true)
+        {
+            if(particleEmitterHandles.empty() == false)
+            {
+                ValidateCpuSimulation(cpuSimulation, particleSystem, particleEmitterPool.Get(particleEmitterHandles.front()));
+            };
+        };
+
+
+        if constexpr(validateAsyncReadback == true)
+        {
+            // Nothing is compared until the previous request arrives, and a new request is only made once it did
+            if(asyncReadback.IsPending() == false)
+            {
+                if(asyncReadbackExpected.empty() == false)
+                {
+                    ValidateAsyncReadback(asyncReadback, asyncReadbackExpected);
+
+                    // The latency doesn't change from readback to readback, once is enough
+                    if(asyncReadbackLatencyPrinted == false)
+                    {
+                        std::cout << "Async readback arrived after " << (particleSystem.GetFrame() - asyncReadbackRequestFrame) << " frames\n";
+
+                        asyncReadbackLatencyPrinted = true;
+                    };
+                };
 
-            particleEmmiter.Draw();
+                if(particleEmitterHandles.empty() == false)
+                {
+                    const ParticleEmmiter& particleEmmiter = particleEmitterPool.Get(particleEmitterHandles.front());
 
+                    // The updated particles are now the input of the next frame
+                    particleSystem.GetInputParticleBuffer().GetBufferAsync<ComputeShaderParticle>(asyncReadback, particleEmmiter.GetNumberOfParticles(), particleEmmiter.GetFirstParticle());
 
-            iterator++;
+                    asyncReadbackExpected.resize(particleEmmiter.GetNumberOfParticles());
+                    particleSystem.GetInputParticleBuffer().GetBuffer(asyncReadbackExpected.data(), asyncReadbackExpected.size(), particleEmmiter.GetFirstParticle());
+
+                    asyncReadbackRequestFrame = particleSystem.GetFrame();
+                };
+            };
         };
 
 
 
         glfwSwapBuffers(glfwWindow);
 
+        framePacer.EndFrame();
+
         timePoint2 = std::chrono::steady_clock::now();
 
         delta = timePoint2 - timePoint1;
@@ -399,10 +889,28 @@ int main()
             elapsedFrames = 0;
             elapsedTime = std::chrono::milliseconds(0);
 
-            char tileBuffer[64] { 0 };
+            // How long the CPU waited for the GPU, on average and at worst
+            const FramePacer::WaitStatistics waitStatistics = framePacer.GetStatistics();
+
+            const float averageWaitTime = (waitStatistics.NumberOfFrames > 0) ? (waitStatistics.TotalWaitTime.count() / waitStatistics.NumberOfFrames) : 0.0f;
+
+            framePacer.ResetStatistics();
+
+
+            char tileBuffer[320] { 0 };
 
 
-            sprintf_s(tileBuffer, sizeof(tileBuffer), "Emmiters: %d, Particles: %d, FPS: %.2f", static_cast<int>(particleEmmiters.size()), static_cast<int>(particleEmmiters.size() * particlesPerEmitter), fps);
+            sprintf_s(tileBuffer, sizeof(tileBuffer), "Emmiters: %d, Particles: %d, FPS: %.2f, Copies saved: %.2f KB/frame, Emitter uploads: %.2f KB/frame, Fragmentation: %.1f%%, Fence wait (%d in flight): %.2fms avg, %.2fms max, %d stalls", 
+                      static_cast<int>(particleEmitterPool.GetNumberOfEmitters()), 
+                      static_cast<int>(particleSystem.GetNumberOfLiveParticles()), 
+                      fps,
+                      particleSystem.GetSavedCopyBytesPerFrame() / 1024.0f,
+                      particleSystem.GetEmitterUploadBytesPerFrame() / 1024.0f,
+                      particleSystem.GetArenaStatistics().Fragmentation * 100.0f,
+                      static_cast<int>(framePacer.GetFramesInFlight()),
+                      averageWaitTime,
+                      waitStatistics.MaxWaitTime.count(),
+                      static_cast<int>(waitStatistics.NumberOfStalls));
 
             // Display FPS
             glfwSetWindowTitle(glfwWindow, tileBuffer);
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+#if defined(_WIN32)
+    // Keeps Windows.h from defining 'min' and 'max' macros, which break std::min and std::max
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+
+    #ifndef WIN32_LEAN_AND_MEAN
+        #define WIN32_LEAN_AND_MEAN
+    #endif
+
+    #include <Windows.h>
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+#endif
+
+
+/// <summary>
+/// A read-only view of a whole file, mapped into memory.
+/// Pages are only read from disk once they're touched, and nothing is copied into a separate buffer
+/// </summary>
+class MappedFile
+{
+
+private:
+
+#if defined(_WIN32)
+    HANDLE _fileHandle = INVALID_HANDLE_VALUE;
+    HANDLE _mappingHandle = nullptr;
+#else
+    int _fileDescriptor = -1;
+#endif
+
+    const std::uint8_t* _data = nullptr;
+
+    std::size_t _sizeInBytes = 0;
+
+
+public:
+
+    /// <summary>
+    /// Map a file. If the file doesn't exist, or can't be mapped, IsOpen() is false
+    /// </summary>
+    /// <param name="path"></param>
+    MappedFile(const std::string& path)
+    {
+    #if defined(_WIN32)
+
+        _fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+        if(_fileHandle == INVALID_HANDLE_VALUE)
+            return;
+
+        LARGE_INTEGER fileSize = { };
+
+        // Empty files can't be mapped
+        if((GetFileSizeEx(_fileHandle, &fileSize) == FALSE) ||
+           (fileSize.QuadPart == 0))
+            return;
+
+        _mappingHandle = CreateFileMappingA(_fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+        if(_mappingHandle == nullptr)
+            return;
+
+        _data = static_cast<const std::uint8_t*>(MapViewOfFile(_mappingHandle, FILE_MAP_READ, 0, 0, 0));
+
+        if(_data != nullptr)
+            _sizeInBytes = static_cast<std::size_t>(fileSize.QuadPart);
+
+    #else
+
+        _fileDescriptor = open(path.c_str(), O_RDONLY);
+
+        if(_fileDescriptor == -1)
+            return;
+
+        struct stat fileStatus = { };
+
+        if((fstat(_fileDescriptor, &fileStatus) == -1) ||
+           (fileStatus.st_size == 0))
+            return;
+
+        void* data = mmap(nullptr, static_cast<std::size_t>(fileStatus.st_size), PROT_READ, MAP_PRIVATE, _fileDescriptor, 0);
+
+        if(data == MAP_FAILED)
+            return;
+
+        _data = static_cast<const std::uint8_t*>(data);
+        _sizeInBytes = static_cast<std::size_t>(fileStatus.st_size);
+
+    #endif
+    };
+
+    MappedFile(const MappedFile&) = delete;
+
+
+    ~MappedFile()
+    {
+    #if defined(_WIN32)
+
+        if(_data != nullptr)
+            UnmapViewOfFile(_data);
+
+        if(_mappingHandle != nullptr)
+            CloseHandle(_mappingHandle);
+
+        if(_fileHandle != INVALID_HANDLE_VALUE)
+            CloseHandle(_fileHandle);
+
+    #else
+
+        if(_data != nullptr)
+            munmap(const_cast<std::uint8_t*>(_data), _sizeInBytes);
+
+        if(_fileDescriptor != -1)
+            close(_fileDescriptor);
+
+    #endif
+    };
+
+
+public:
+
+    bool IsOpen() const
+    {
+        return _data != nullptr;
+    };
+
+    const std::uint8_t* GetData() const
+    {
+        return _data;
+    };
+
+    std::size_t GetSizeInBytes() const
+    {
+        return _sizeInBytes;
+    };
+
+
+public:
+
+    MappedFile& operator = (const MappedFile&) = delete;
+
+};
\ No newline at end of file
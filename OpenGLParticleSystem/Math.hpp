@@ -1,6 +1,7 @@
 #pragma once
 #define GLM_CONSTEXPR_SIMD
 
+#include <cstdint>
 #include <glm/vec2.hpp>
 #include <glm/glm.hpp>
 
@@ -52,20 +53,65 @@ constexpr glm::vec2 MouseToCartesian()
 
 
 
-float RandomNumberGenerator(const glm::vec2& uv, float seed)
+/// <summary>
+/// A counter-based random number stream. 
+/// Streams are keyed by (seed, emitter, particle, frame), so particles can be initialized in parallel, in any order, and with the same results on every run.
+/// Must stay identical to the implementation in ParticleShaderCommon.glsl
+/// </summary>
+struct RandomStream
+{
+    std::uint32_t Key = 0;
+
+    /// <summary>
+    /// The number of values that were taken from this stream
+    /// </summary>
+    std::uint32_t Counter = 0;
+};
+
+
+/// <summary>
+/// PCG hash, from "Hash Functions for GPU Rendering" (Jarzynski and Olano, 2020)
+/// </summary>
+/// <param name="value"></param>
+/// <returns></returns>
+constexpr std::uint32_t PcgHash(const std::uint32_t value)
+{
+    const std::uint32_t state = value * 747796405u + 2891336453u;
+    const std::uint32_t word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+
+    return (word >> 22u) ^ word;
+};
+
+constexpr RandomStream CreateRandomStream(const std::uint32_t seed, const std::uint32_t emitterIndex, const std::uint32_t particleIndex, const std::uint32_t frame)
+{
+    return
+    {
+        .Key = PcgHash(seed ^ PcgHash(emitterIndex ^ PcgHash(particleIndex ^ PcgHash(frame)))),
+        .Counter = 0,
+    };
+};
+
+
+/// <summary>
+/// Take the next number from a stream
+/// </summary>
+/// <param name="stream"></param>
+/// <returns> A number in [0, 1) </returns>
+constexpr float RandomNumberGenerator(RandomStream& stream)
 {
-    const float fixedSeed = std::fabs(seed) + 1.0f;
-    
-    const float x = glm::dot(uv, glm::vec2(12.9898, 78.233) * fixedSeed);
+    const std::uint32_t bits = PcgHash(stream.Key + stream.Counter);
+
+    stream.Counter++;
 
-    return glm::fract(glm::sin(x) * 43758.5453f);
+    // 24 bits fit exactly in a float, so the result is the same on the CPU and the GPU
+    return static_cast<float>(bits >> 8u) * (1.0f / 16777216.0f);
 };
 
-float RandomNumberGenerator(const glm::vec2& uv, float seed, float min, float max)
+constexpr float RandomNumberGenerator(RandomStream& stream, float min, float max)
 {
-    const float rng = RandomNumberGenerator(uv, seed);
+    const float rng = RandomNumberGenerator(stream);
 
-    // Map [0, 1] to [min, max] 
+    // Map [0, 1) to [min, max) 
     const float rngResult = min + rng * (max - min);
 
     return rngResult;
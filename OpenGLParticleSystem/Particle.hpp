@@ -0,0 +1,224 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <glm/vec2.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/geometric.hpp>
+
+
+/// <summary>
+/// The bare-minimm particle data that is needed to send to the compute shader.
+/// Every particle of an emitter shares the emitter's ParticleTransform, so it's kept in EmitterParameters instead. 
+/// Values that only change when a particle resets are stored as half-floats.
+/// Must match the std430 layout of the 'Particle' struct in ParticleShaderCommon.glsl
+/// </summary>
+struct ComputeShaderParticle
+{
+    /// <summary>
+    /// The position of this particle in it's trajectory path. The Y position is calculated from it
+    /// </summary>
+    float TrajectoryX = 0.0f;
+
+    float Opacity = 0.0f;
+
+    /// <summary>
+    /// packHalf2x16(TrajectoryA, TrajectoryB), the 'a' and 'b' coefficients of the trajectory's parabola
+    /// </summary>
+    std::uint32_t PackedTrajectory = 0;
+
+    /// <summary>
+    /// packHalf2x16(Rate, OpacityDecreaseRate)
+    /// </summary>
+    std::uint32_t PackedRates = 0;
+
+    /// <summary>
+    /// The index of the emitter (In the emitter parameters buffer) this particle belongs to
+    /// </summary>
+    std::uint32_t EmitterIndex = 0;
+};
+
+static_assert(sizeof(ComputeShaderParticle) == 20, "ComputeShaderParticle doesn't match the std430 'Particle' struct");
+static_assert(offsetof(ComputeShaderParticle, TrajectoryX) == 0, "ComputeShaderParticle doesn't match the std430 'Particle' struct");
+static_assert(offsetof(ComputeShaderParticle, Opacity) == 4, "ComputeShaderParticle doesn't match the std430 'Particle' struct");
+static_assert(offsetof(ComputeShaderParticle, PackedTrajectory) == 8, "ComputeShaderParticle doesn't match the std430 'Particle' struct");
+static_assert(offsetof(ComputeShaderParticle, PackedRates) == 12, "ComputeShaderParticle doesn't match the std430 'Particle' struct");
+static_assert(offsetof(ComputeShaderParticle, EmitterIndex) == 16, "ComputeShaderParticle doesn't match the std430 'Particle' struct");
+
+
+/// <summary>
+/// How an emitter's particles are spawned and drawn, so emitters that behave differently can still be updated by a single dispatch.
+/// Must match the 'EmitterBehaviour' struct in ParticleShaderCommon.glsl
+/// </summary>
+struct alignas(8) EmitterBehaviour
+{
+    /// <summary>
+    /// Even particles go left and odd particles go right
+    /// </summary>
+    static constexpr std::uint32_t AlternateDirectionsFlag = 1 << 0;
+
+    /// <summary>
+    /// When directions don't alternate, every particle goes left instead of right
+    /// </summary>
+    static constexpr std::uint32_t LeftDirectionFlag = 1 << 1;
+
+
+    /// <summary>
+    /// The (min, max) ranges a particle's values are drawn from whenever it resets
+    /// </summary>
+    glm::vec2 TrajectoryARange = glm::vec2(0.01f, 0.1f);
+    glm::vec2 TrajectoryBRange = glm::vec2(4.0f, 4.5f);
+    glm::vec2 RateRange = glm::vec2(11.5f, 20.0f);
+    glm::vec2 OpacityDecreaseRateRange = glm::vec2(0.05f, 0.1f);
+
+    /// <summary>
+    /// The emitter's particles cycle through NumberOfSprites of the particle system's sprites, starting at FirstSprite. 
+    /// 0 sprites means every sprite, and FirstSprite is ignored
+    /// </summary>
+    std::uint32_t FirstSprite = 0;
+    std::uint32_t NumberOfSprites = 0;
+
+    std::uint32_t Flags = AlternateDirectionsFlag;
+};
+
+static_assert(sizeof(EmitterBehaviour) == 48, "EmitterBehaviour doesn't match the std430 'EmitterBehaviour' struct");
+static_assert(offsetof(EmitterBehaviour, TrajectoryBRange) == 8, "EmitterBehaviour doesn't match the std430 'EmitterBehaviour' struct");
+static_assert(offsetof(EmitterBehaviour, RateRange) == 16, "EmitterBehaviour doesn't match the std430 'EmitterBehaviour' struct");
+static_assert(offsetof(EmitterBehaviour, OpacityDecreaseRateRange) == 24, "EmitterBehaviour doesn't match the std430 'EmitterBehaviour' struct");
+static_assert(offsetof(EmitterBehaviour, FirstSprite) == 32, "EmitterBehaviour doesn't match the std430 'EmitterBehaviour' struct");
+static_assert(offsetof(EmitterBehaviour, NumberOfSprites) == 36, "EmitterBehaviour doesn't match the std430 'EmitterBehaviour' struct");
+static_assert(offsetof(EmitterBehaviour, Flags) == 40, "EmitterBehaviour doesn't match the std430 'EmitterBehaviour' struct");
+
+
+/// <summary>
+/// Per-emitter data the compute shader reads through a particle's EmitterIndex.
+/// The emitter's transforms are reduced to 2D affine math, which assumes they only translate and uniformly scale.
+/// Must match the 'Emitter' struct in ParticleShaderCommon.glsl
+/// </summary>
+struct alignas(8) EmitterParameters
+{
+    /// <summary>
+    /// Where, in NDC, a particle at the start of its trajectory is drawn
+    /// </summary>
+    glm::vec2 Origin = glm::vec2(0.0f);
+
+    /// <summary>
+    /// How far, in NDC, a particle moves per unit of scaled NDC trajectory along X and Y
+    /// </summary>
+    glm::vec2 AxisX = glm::vec2(0.0f);
+    glm::vec2 AxisY = glm::vec2(0.0f);
+
+    /// <summary>
+    /// Half the size of a particle's quad, in NDC
+    /// </summary>
+    float Scale = 0.0f;
+
+    /// <summary>
+    /// Particles of inactive emitters are neither updated nor visible
+    /// </summary>
+    std::uint32_t Active = 0;
+
+    /// <summary>
+    /// Keys the random streams of the emitter's particles, see RandomStream
+    /// </summary>
+    std::uint32_t Seed = 0;
+
+    /// <summary>
+    /// Particles of a draining emitter don't reset, and are counted until every one of them faded out
+    /// </summary>
+    std::uint32_t Draining = 0;
+
+    EmitterBehaviour Behaviour;
+
+
+    /// <summary>
+    /// Reduce an emitter's transforms to the values the compute shader needs. 
+    /// A particle's screen transform used to be 'Translate(emitterTransform, ndc) * particleTransform', 
+    /// which moves the particle's center to '(emitterTransform * particleTransform)[3] + (emitterTransform[0] * ndc.x + emitterTransform[1] * ndc.y) * particleTransform[3][3]'
+    /// </summary>
+    /// <param name="emitterTransform"> A transform that will be applied to every particle of the emitter. Can be thought of as the "View-Transform" </param>
+    /// <param name="particleTransform"> A transform that will be applied to every particle of the emitter, before the emitterTransform </param>
+    /// <param name="seed"></param>
+    /// <param name="behaviour"></param>
+    /// <returns></returns>
+    static EmitterParameters FromTransforms(const glm::mat4& emitterTransform, const glm::mat4& particleTransform, const std::uint32_t seed, const EmitterBehaviour& behaviour = EmitterBehaviour())
+    {
+        const glm::mat4 emitterParticleTransform = emitterTransform * particleTransform;
+
+        return
+        {
+            .Origin = glm::vec2(emitterParticleTransform[3]),
+
+            .AxisX = glm::vec2(emitterTransform[0]) * particleTransform[3][3],
+            .AxisY = glm::vec2(emitterTransform[1]) * particleTransform[3][3],
+
+            .Scale = glm::length(glm::vec2(emitterParticleTransform[0])),
+
+            .Active = 1,
+            .Seed = seed,
+
+            .Behaviour = behaviour,
+        };
+    };
+};
+
+static_assert(sizeof(EmitterParameters) == 88, "EmitterParameters doesn't match the std430 'Emitter' struct");
+static_assert(offsetof(EmitterParameters, AxisX) == 8, "EmitterParameters doesn't match the std430 'Emitter' struct");
+static_assert(offsetof(EmitterParameters, AxisY) == 16, "EmitterParameters doesn't match the std430 'Emitter' struct");
+static_assert(offsetof(EmitterParameters, Scale) == 24, "EmitterParameters doesn't match the std430 'Emitter' struct");
+static_assert(offsetof(EmitterParameters, Active) == 28, "EmitterParameters doesn't match the std430 'Emitter' struct");
+static_assert(offsetof(EmitterParameters, Seed) == 32, "EmitterParameters doesn't match the std430 'Emitter' struct");
+static_assert(offsetof(EmitterParameters, Draining) == 36, "EmitterParameters doesn't match the std430 'Emitter' struct");
+static_assert(offsetof(EmitterParameters, Behaviour) == 40, "EmitterParameters doesn't match the std430 'Emitter' struct");
+
+
+/// <summary>
+/// A range of particles the seeding compute shader initializes for a newly created emitter.
+/// Must match the 'SeedRequest' struct in ParticleSeedShader.glsl
+/// </summary>
+struct EmitterSeedRequest
+{
+    std::uint32_t FirstParticle = 0;
+    std::uint32_t NumberOfParticles = 0;
+
+    std::uint32_t EmitterIndex = 0;
+};
+
+static_assert(sizeof(EmitterSeedRequest) == 12, "EmitterSeedRequest doesn't match the std430 'SeedRequest' struct");
+
+
+
+/// <summary>
+/// Per-frame data every particle program reads from one uniform buffer, instead of each program getting its own copies as uniforms.
+/// Must match the std140 layout of the 'SceneBuffer' block in SceneUniforms.glsl
+/// </summary>
+struct SceneUniforms
+{
+    /// <summary>
+    /// Multiplies a particle's cartesian trajectory position into NDC, already divided by the particle scale factor. 
+    /// (2 / (WindowWidth * ParticleScaleFactor), 2 / (WindowHeight * ParticleScaleFactor)), so no shader has to divide per particle
+    /// </summary>
+    glm::vec2 CartesianToScaledNDC = glm::vec2(0.0f);
+
+    float DeltaTime = 0.0f;
+
+    /// <summary>
+    /// Keys the random streams of particles that reset this frame
+    /// </summary>
+    std::uint32_t Frame = 0;
+
+    /// <summary>
+    /// Particles cycle through the sprites by their index, unless their emitter picks a set of sprites
+    /// </summary>
+    std::uint32_t NumberOfSprites = 0;
+
+    /// <summary>
+    /// Rounds the block up to a multiple of a vec4
+    /// </summary>
+    std::uint32_t Padding[3] = { };
+};
+
+static_assert(sizeof(SceneUniforms) == 32, "SceneUniforms doesn't match the std140 'SceneBuffer' block");
+static_assert(offsetof(SceneUniforms, DeltaTime) == 8, "SceneUniforms doesn't match the std140 'SceneBuffer' block");
+static_assert(offsetof(SceneUniforms, Frame) == 12, "SceneUniforms doesn't match the std140 'SceneBuffer' block");
+static_assert(offsetof(SceneUniforms, NumberOfSprites) == 16, "SceneUniforms doesn't match the std140 'SceneBuffer' block");
\ No newline at end of file
@@ -0,0 +1,246 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+
+
+/// <summary>
+/// Sub-allocates ranges of particles from the particle system's buffers.
+/// Only the bookkeeping lives here, moving the particles themselves when the arena is compacted is up to the caller
+/// </summary>
+class ParticleArena
+{
+
+public:
+
+    /// <summary>
+    /// A contiguous range of particles
+    /// </summary>
+    struct Block
+    {
+        std::uint32_t FirstParticle = 0;
+        std::uint32_t NumberOfParticles = 0;
+    };
+
+    /// <summary>
+    /// A range of allocated particles that compaction moved down
+    /// </summary>
+    struct Move
+    {
+        std::uint32_t SourceFirstParticle = 0;
+        std::uint32_t DestinationFirstParticle = 0;
+        std::uint32_t NumberOfParticles = 0;
+    };
+
+    /// <summary>
+    /// A snapshot of how the arena is used
+    /// </summary>
+    struct Statistics
+    {
+        std::uint32_t CapacityInParticles = 0;
+
+        std::uint32_t AllocatedParticles = 0;
+
+        /// <summary>
+        /// One past the last allocated particle. Everything below it is updated and drawn
+        /// </summary>
+        std::uint32_t HighWaterMark = 0;
+
+        /// <summary>
+        /// Particles in holes below the high water mark
+        /// </summary>
+        std::uint32_t FreeParticlesInHoles = 0;
+
+        std::uint32_t NumberOfHoles = 0;
+
+        std::uint32_t LargestHole = 0;
+
+        /// <summary>
+        /// How much of the space below the high water mark is wasted, between 0 and 1
+        /// </summary>
+        float Fragmentation = 0.0f;
+    };
+
+
+private:
+
+    std::uint32_t _capacityInParticles;
+
+    /// <summary>
+    /// Freed blocks below the high water mark, sorted by their first particle. Adjacent blocks are always merged
+    /// </summary>
+    std::vector<Block> _freeBlocks;
+
+    std::uint32_t _highWaterMark = 0;
+
+    std::uint32_t _allocatedParticles = 0;
+
+
+public:
+
+    ParticleArena(const std::uint32_t capacityInParticles) :
+        _capacityInParticles(capacityInParticles)
+    {
+    };
+
+
+public:
+
+    /// <summary>
+    /// Allocate a block, reusing the first freed block that is large enough before growing the high water mark
+    /// </summary>
+    /// <param name="numberOfParticles"></param>
+    /// <param name="block"> The allocated block </param>
+    /// <returns> False if there is no room, even though compacting might make room </returns>
+    bool Allocate(const std::uint32_t numberOfParticles, Block& block)
+    {
+        const auto freeBlock = std::find_if(_freeBlocks.begin(), _freeBlocks.end(), [numberOfParticles](const Block& freeBlock)
+        {
+            return freeBlock.NumberOfParticles >= numberOfParticles;
+        });
+
+        if(freeBlock != _freeBlocks.end())
+        {
+            block = { .FirstParticle = freeBlock->FirstParticle, .NumberOfParticles = numberOfParticles };
+
+            // Whatever is left of the free block stays free
+            freeBlock->FirstParticle += numberOfParticles;
+            freeBlock->NumberOfParticles -= numberOfParticles;
+
+            if(freeBlock->NumberOfParticles == 0)
+                _freeBlocks.erase(freeBlock);
+        }
+        else
+        {
+            if((_capacityInParticles - _highWaterMark) < numberOfParticles)
+                return false;
+
+            block = { .FirstParticle = _highWaterMark, .NumberOfParticles = numberOfParticles };
+
+            _highWaterMark += numberOfParticles;
+        };
+
+        _allocatedParticles += numberOfParticles;
+
+        return true;
+    };
+
+
+    /// <summary>
+    /// Release a block that was returned by Allocate()
+    /// </summary>
+    /// <param name="block"></param>
+    void Free(const Block& block)
+    {
+        _allocatedParticles -= block.NumberOfParticles;
+
+        const auto next = std::lower_bound(_freeBlocks.begin(), _freeBlocks.end(), block.FirstParticle, [](const Block& freeBlock, const std::uint32_t firstParticle)
+        {
+            return freeBlock.FirstParticle < firstParticle;
+        });
+
+        auto inserted = _freeBlocks.insert(next, block);
+
+        // Merge with the following block
+        if(((inserted + 1) != _freeBlocks.end()) &&
+           ((inserted->FirstParticle + inserted->NumberOfParticles) == (inserted + 1)->FirstParticle))
+        {
+            inserted->NumberOfParticles += (inserted + 1)->NumberOfParticles;
+            _freeBlocks.erase(inserted + 1);
+        };
+
+        // Merge with the preceding block
+        if((inserted != _freeBlocks.begin()) &&
+           (((inserted - 1)->FirstParticle + (inserted - 1)->NumberOfParticles) == inserted->FirstParticle))
+        {
+            (inserted - 1)->NumberOfParticles += inserted->NumberOfParticles;
+            inserted = _freeBlocks.erase(inserted) - 1;
+        };
+
+        // A free block at the end isn't a hole, it just lowers the high water mark
+        if((inserted->FirstParticle + inserted->NumberOfParticles) == _highWaterMark)
+        {
+            _highWaterMark = inserted->FirstParticle;
+            _freeBlocks.erase(inserted);
+        };
+    };
+
+
+    /// <summary>
+    /// Pack every allocated particle at the start of the arena, removing every hole
+    /// </summary>
+    /// <returns> The ranges of allocated particles that have to be moved, in order </returns>
+    std::vector<Move> Compact()
+    {
+        std::vector<Move> moves;
+        moves.reserve(_freeBlocks.size());
+
+        // Everything between two holes is allocated, and moves down by the size of every hole before it
+        std::uint32_t shift = 0;
+
+        for(std::size_t i = 0; i < _freeBlocks.size(); i++)
+        {
+            const Block& hole = _freeBlocks[i];
+
+            shift += hole.NumberOfParticles;
+
+            const std::uint32_t spanStart = hole.FirstParticle + hole.NumberOfParticles;
+            const std::uint32_t spanEnd = ((i + 1) < _freeBlocks.size()) ? _freeBlocks[i + 1].FirstParticle : _highWaterMark;
+
+            moves.push_back(
+            {
+                .SourceFirstParticle = spanStart,
+                .DestinationFirstParticle = spanStart - shift,
+                .NumberOfParticles = spanEnd - spanStart,
+            });
+        };
+
+        _highWaterMark -= shift;
+        _freeBlocks.clear();
+
+        return moves;
+    };
+
+
+    /// <summary>
+    /// Should the arena be compacted
+    /// </summary>
+    /// <param name="maxFragmentation"> The fragmentation that is still tolerated </param>
+    /// <returns></returns>
+    bool IsFragmented(const float maxFragmentation) const
+    {
+        return GetStatistics().Fragmentation > maxFragmentation;
+    };
+
+
+public:
+
+    Statistics GetStatistics() const
+    {
+        Statistics statistics =
+        {
+            .CapacityInParticles = _capacityInParticles,
+            .AllocatedParticles = _allocatedParticles,
+            .HighWaterMark = _highWaterMark,
+            .NumberOfHoles = static_cast<std::uint32_t>(_freeBlocks.size()),
+        };
+
+        for(const Block& freeBlock : _freeBlocks)
+        {
+            statistics.FreeParticlesInHoles += freeBlock.NumberOfParticles;
+            statistics.LargestHole = std::max(statistics.LargestHole, freeBlock.NumberOfParticles);
+        };
+
+        if(_highWaterMark != 0)
+            statistics.Fragmentation = static_cast<float>(statistics.FreeParticlesInHoles) / _highWaterMark;
+
+        return statistics;
+    };
+
+    std::uint32_t GetHighWaterMark() const
+    {
+        return _highWaterMark;
+    };
+
+};
\ No newline at end of file
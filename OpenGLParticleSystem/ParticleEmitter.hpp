@@ -4,85 +4,15 @@
 #include <glm/mat4x4.hpp>
 #include <functional>
 #include <glad/glad.h>
-#include <GLFW/glfw3.h>
 
-#include "ShaderProgram.hpp"
-#include "VertexArray.hpp"
-#include "Texture.hpp"
-#include "Math.hpp"
-#include "ShaderStorageBuffer.hpp"
-#include "ComputeShaderProgram.hpp"
+#include "Particle.hpp"
+#include "ParticleSystem.hpp"
 
 
-// Defined in Main.cpp
-extern int WindowWidth;
-extern int WindowHeight;
-
-
-
-struct Particle
-{
-    /// <summary>
-    /// The 'a' coefficient in a parabola
-    /// </summary>
-    float TrajectoryA = 0.0f;
-
-    /// <summary>
-    /// The 'b' coefficient  in a parabola
-    /// </summary>
-    float TrajectoryB = 0.0f;
-
-    /// <summary>
-    /// The position of this particle in it's trajectory path
-    /// </summary>
-    glm::vec2 Trajectory = glm::vec2(0.0f);
-
-    /// <summary>
-    /// The rate at which this particle will move
-    /// </summary>
-    float Rate = 0.0f;
-
-    /// <summary>
-    /// A transform which will modify how this particle looks
-    /// </summary>
-    glm::mat4 Transform = glm::mat4(1.0f);
-
-    float Opacity = 0.0f;
-
-    /// <summary>
-    /// How fast will the particle's opacity decay
-    /// </summary>
-    float OpacityDecreaseRate = 0.0f;
-
-    /// <summary>
-    /// This particle's texture
-    /// </summary>
-    std::uint32_t TextureID = 0;
-};
-
-
-/// <summary>
-/// The bare-minimm particle data that is needed to send to the compute shader
-/// </summary>
-struct alignas(16) ComputeShaderParticle
-{
-    float TrajectoryA = 0.0f;
-    float TrajectoryB = 0.0f;
-
-    alignas(8) glm::vec2 Trajectory = glm::vec2(1.0f);
-
-    glm::mat4 Transform = glm::mat4(1.0f);
-
-    float Rate = 0.0f;
-
-    float Opacity = 0.0f;
-
-    float OpacityDecreaseRate = 0.0f;
-};
-
 
 /// <summary>
 /// An emitter of particles. 
+/// The emitter's particles are stored in a range of a ParticleSystem's buffers
 /// </summary>
 class ParticleEmmiter
 {
@@ -90,90 +20,48 @@ class ParticleEmmiter
 private:
 
     /// <summary>
-    /// The number of particles that will be drawn
+    /// Marks an emitter that was moved from, and no longer owns an emitter index
     /// </summary>
-    std::uint32_t _numberOfParticles;
-
-    /// <summary>
-    /// A reference to the shader program which will draw the particles
-    /// </summary>
-    std::reference_wrapper<const ShaderProgram> _particleShaderProgram;
+    static constexpr std::uint32_t InvalidEmitterIndex = static_cast<std::uint32_t>(-1);
 
 
     /// <summary>
-    /// A transform that will be applied for every particle at the moment the 'Update()' function is called.
-    /// Can be thought of as the "View-Transform" 
-    /// </summary>
-    glm::mat4 _particleEmmiterTransform;
-
-    /// <summary>
-    /// A particle transform that will be applied to a given particle after it is reset.
-    /// </summary>
-    glm::mat4 _particleTransform;
-
-
-    float _particleScaleFactor;
-
-
-    /// <summary>
-    /// A VAO for the particles
+    /// The number of particles that will be drawn
     /// </summary>
-    std::reference_wrapper<const VertexArray> _particleVAO;
-
+    std::uint32_t _numberOfParticles;
 
     /// <summary>
-    /// A list of particle textures
+    /// The particle system which stores this emitter's particles
     /// </summary>
-    std::vector<const Texture*> _particleTextures;
-
+    std::reference_wrapper<ParticleSystem> _particleSystem;
 
     /// <summary>
-    /// A reference to VBO of particle vertex positions
+    /// This emitter's index inside the particle system's emitter parameters
     /// </summary>
-    std::reference_wrapper<const VertexBuffer> _particleVertexPositionVBO;
+    std::uint32_t _emitterIndex;
 
     /// <summary>
-    /// A reference to a VBO of per-instance particle transforms
+    /// Keys the random streams of this emitter's particles
     /// </summary>
-    std::reference_wrapper<const VertexBuffer> _particleTransformVBO;
+    std::uint32_t _seed;
 
 
     /// <summary>
-    /// A reference to a VBO of per-instance particle opacities
-    /// </summary>
-    std::reference_wrapper<const VertexBuffer> _particleOpacityVBO;
-
-    /// <summary>
-    /// A reference to a particle transform compute shader
-    /// </summary>
-    std::reference_wrapper<const ComputeShaderProgram> _computeShaderProgram;
-
-
-    /// <summary>
-    /// An input SSBO for particle data
-    /// </summary>
-    ShaderStorageBuffer _inputParticleBuffer;
-
-    /// <summary>
-    /// The resulting output data of particle data after the compute shader has run
+    /// A transform that will be applied for every particle at the moment the 'Update()' function is called.
+    /// Can be thought of as the "View-Transform" 
     /// </summary>
-    ShaderStorageBuffer _outputParticleBuffer;
+    glm::mat4 _particleEmmiterTransform;
 
     /// <summary>
-    /// An output SSBO of particle screen transforms
+    /// A particle transform that will be applied to every particle of this emitter
     /// </summary>
-    ShaderStorageBuffer _outputParticleScreenTransformBuffer;
+    glm::mat4 _particleTransform;
 
     /// <summary>
-    /// An output SSBO of particle opacities
+    /// How this emitter's particles are spawned and drawn
     /// </summary>
-    ShaderStorageBuffer _outputParticleOpacitiesBuffer;
-
+    EmitterBehaviour _behaviour;
 
-    /// <summary>
-    /// A list of particles
-    /// </summary>
-    std::vector<Particle> _particles;
 
     /// <summary>
     /// A boolean flag that indicates if this emitter is in the process of being destroyed
@@ -183,254 +71,226 @@ private:
 
 public:
 
-    ParticleEmmiter(const std::uint32_t numberOfParticles,
-                    const float particleScaleFactor,
+    ParticleEmmiter(ParticleSystem& particleSystem,
+                    const glm::mat4& particleEmitterTransform) :
+        ParticleEmmiter(particleSystem, particleEmitterTransform, particleSystem.GetParticlesPerEmitter())
+    {
+    };
+
+    ParticleEmmiter(ParticleSystem& particleSystem,
                     const glm::mat4& particleEmitterTransform,
-                    const ShaderProgram& shaderProgram,
-                    const VertexArray& particleVAO,
-                    const std::vector<const Texture*>& textures,
-                    const VertexBuffer& particleVertexPositionVBO,
-                    const VertexBuffer& particleTransformVBO,
-                    const VertexBuffer& particleOpacityVBO,
-                    const ComputeShaderProgram& computeShaderProgram) :
-        // const ShaderStorageBuffer& inputBuffer,
-        // const ShaderStorageBuffer& outputBuffer,
-        // const ShaderStorageBuffer& outputParticleScreenTransformBuffer) :
+                    const std::uint32_t numberOfParticles) :
         _numberOfParticles(numberOfParticles),
-        _particleShaderProgram(shaderProgram),
+        _particleSystem(particleSystem),
+        _emitterIndex(particleSystem.AllocateEmitter(numberOfParticles)),
+        _seed(particleSystem.GenerateEmitterSeed()),
         _particleEmmiterTransform(particleEmitterTransform),
-        _particleTransform(glm::mat4(1.0f)),
-        _particleScaleFactor(particleScaleFactor),
-        _particleVAO(particleVAO),
-        _particleTextures(textures),
-        _particleVertexPositionVBO(particleVertexPositionVBO),
-        _particleTransformVBO(particleTransformVBO),
-        _particleOpacityVBO(particleOpacityVBO),
-        _computeShaderProgram(computeShaderProgram),
-        // _inputParticleBuffer(inputBuffer),
-        // _outputParticletBuffer(outputBuffer),
-        // _outputParticleScreenTransformBuffer(outputParticleScreenTransformBuffer)
-        _inputParticleBuffer(nullptr, sizeof(ComputeShaderParticle)* numberOfParticles, 0, GL_DYNAMIC_COPY),
-        _outputParticleBuffer(nullptr, sizeof(ComputeShaderParticle)* numberOfParticles, 1),
-        _outputParticleScreenTransformBuffer(nullptr, sizeof(glm::mat4)* numberOfParticles, 2),
-        _outputParticleOpacitiesBuffer(nullptr, sizeof(float)* numberOfParticles, 3),
-        _particles(numberOfParticles)
+        _particleTransform(glm::mat4(1.0f))
     {
+        // The seeding shader reads the emitter's seed
+        UploadEmitterParameters();
 
-        // Initialize particles
-        for(std::size_t index = 0;
-            Particle & particle : _particles)
-        {
-            InitializeParticleValues(particle, index);
-            index++;
-        };
-
-
-        // Fill the initial input SSBO with particle data
-        _inputParticleBuffer.Bind();
-
-        for(std::size_t i = 0; i < _numberOfParticles; i++)
-        {
-            const ComputeShaderParticle temp =
-            {
-                .TrajectoryA = _particles[i].TrajectoryA,
-                .TrajectoryB = _particles[i].TrajectoryB,
+        // The particles are initialized on the GPU, together with every other emitter created before the next update
+        _particleSystem.get().SeedEmitter(_emitterIndex, GetFirstParticle(), _numberOfParticles);
+    };
 
-                .Trajectory = _particles[i].Trajectory,
 
-                .Transform = _particles[i].Transform,
+    ParticleEmmiter(ParticleEmmiter&& other) noexcept :
+        _numberOfParticles(other._numberOfParticles),
+        _particleSystem(other._particleSystem),
+        _emitterIndex(other._emitterIndex),
+        _seed(other._seed),
+        _particleEmmiterTransform(other._particleEmmiterTransform),
+        _particleTransform(other._particleTransform),
+        _behaviour(other._behaviour),
+        _desrtoyRequested(other._desrtoyRequested)
+    {
+        // The other emitter no longer owns the emitter index
+        other._emitterIndex = InvalidEmitterIndex;
+    };
 
-                .Rate = _particles[i].Rate,
+    ParticleEmmiter(const ParticleEmmiter&) = delete;
 
-                .Opacity = _particles[i].Opacity,
-                .OpacityDecreaseRate = _particles[i].OpacityDecreaseRate,
-            };
 
-            glBufferSubData(GL_SHADER_STORAGE_BUFFER, sizeof(ComputeShaderParticle) * i, sizeof(ComputeShaderParticle), &temp);
-        };
+    ~ParticleEmmiter()
+    {
+        if(_emitterIndex != InvalidEmitterIndex)
+            _particleSystem.get().FreeEmitter(_emitterIndex);
     };
 
 
-
 public:
 
+    /// <summary>
+    /// Bind the particle system's state. Every emitter of the particle system shares it, so binding it once per frame is enough for all of them
+    /// </summary>
     void Bind() const
     {
-        _particleVAO.get().Bind();
-
-
-        _computeShaderProgram.get().Bind();
-
-        // Update compute shader uniforms
-        _computeShaderProgram.get().SetUniformValue<glm::mat4>("ParticleEmmiterTransform", _particleEmmiterTransform);
-        _computeShaderProgram.get().SetUniformValue<glm::mat4>("ParticleTransform", _particleTransform);
-
-        _computeShaderProgram.get().SetUniformValue<std::uint32_t>("WindowWidth", WindowWidth);
-        _computeShaderProgram.get().SetUniformValue<std::uint32_t>("WindowHeight", WindowHeight);
-
-        _computeShaderProgram.get().SetUniformValue<float>("ParticleScaleFactor", _particleScaleFactor);
-
-        // Bind SSBOs to their respective binding points
-        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, _inputParticleBuffer.GetBufferID());
-        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, _outputParticleBuffer.GetBufferID());
-        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, _outputParticleScreenTransformBuffer.GetBufferID());
-        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, _outputParticleOpacitiesBuffer.GetBufferID());
-
-
-        _particleShaderProgram.get().Bind();
-
-
-        _particleVertexPositionVBO.get().Bind();
-
-        std::uint32_t index = 0;
-        for(const Texture* particleTexture : _particleTextures)
-        {
-            particleTexture->Bind(index);
-
-            std::string uniformName;
-            uniformName.reserve(16);
-
-            uniformName.append("Textures[").append(std::to_string(index)).append("]");
-            _particleShaderProgram.get().SetInt(uniformName, index);
-
-            index++;
-        };
+        _particleSystem.get().Bind();
     };
 
 
+    /// <summary>
+    /// Update only this emitter's particles
+    /// </summary>
+    /// <param name="deltaTime"></param>
     void Update(const float deltaTime)
     {
-        _computeShaderProgram.get().SetUniformValue<float>("DeltaTime", deltaTime);
-
-        _computeShaderProgram.get().Dispatch((_numberOfParticles / 64) + 1);
+        _particleSystem.get().UpdateEmitter(deltaTime, _emitterIndex);
+    };
 
 
-        // Convert the opacity SSBO to a VBO
-        glBindBuffer(GL_ARRAY_BUFFER, _outputParticleOpacitiesBuffer.GetBufferID());
+    /// <summary>
+    /// Draw only this emitter's particles
+    /// </summary>
+    void Draw() const
+    {
+        _particleSystem.get().DrawRange(GetFirstParticle(), _numberOfParticles);
+    };
 
-        glVertexAttribPointer(2, 1, GL_FLOAT, false, sizeof(float), 0);
-        glVertexAttribDivisor(2, 1);
 
+    /// <summary>
+    /// Stop resetting this emitter's particles. Once every particle faded out GetDestroyed() returns true, and the emitter can be removed
+    /// </summary>
+    void Destory()
+    {
+        if(_desrtoyRequested == true)
+            return;
 
+        _desrtoyRequested = true;
 
-        // "Convert" the output SSBO to a VBO and bind to the vertex shader's transform vertex layout
-        glBindBuffer(GL_ARRAY_BUFFER, _outputParticleScreenTransformBuffer.GetBufferID());
+        UploadEmitterParameters();
 
-        constexpr std::uint32_t vertexTransformIndex = 4;
+        _particleSystem.get().DrainEmitter(_emitterIndex);
+    };
 
-        glVertexAttribPointer(vertexTransformIndex + 0, 4, GL_FLOAT, false, sizeof(glm::mat4), reinterpret_cast<const void*>(sizeof(glm::vec4) * 0));
-        glEnableVertexAttribArray(vertexTransformIndex + 0);
-        glVertexAttribDivisor(vertexTransformIndex + 0, 1);
 
-        glVertexAttribPointer(vertexTransformIndex + 1, 4, GL_FLOAT, false, sizeof(glm::mat4), reinterpret_cast<const void*>(sizeof(glm::vec4) * 1));
-        glEnableVertexAttribArray(vertexTransformIndex + 1);
-        glVertexAttribDivisor(vertexTransformIndex + 1, 1);
+    const glm::mat4& GetParticleEmmiterTransform() const
+    {
+        return _particleEmmiterTransform;
+    };
 
-        glVertexAttribPointer(vertexTransformIndex + 2, 4, GL_FLOAT, false, sizeof(glm::mat4), reinterpret_cast<const void*>(sizeof(glm::vec4) * 2));
-        glEnableVertexAttribArray(vertexTransformIndex + 2);
-        glVertexAttribDivisor(vertexTransformIndex + 2, 1);
+    void SetParticleEmmiterTransform(const glm::mat4& particleEmmiterTransform)
+    {
+        _particleEmmiterTransform = particleEmmiterTransform;
 
-        glVertexAttribPointer(vertexTransformIndex + 3, 4, GL_FLOAT, false, sizeof(glm::mat4), reinterpret_cast<const void*>(sizeof(glm::vec4) * 3));
-        glEnableVertexAttribArray(vertexTransformIndex + 3);
-        glVertexAttribDivisor(vertexTransformIndex + 3, 1);
+        UploadEmitterParameters();
+    };
 
 
+    const glm::mat4& GetParticleTransform() const
+    {
+        return _particleTransform;
+    };
 
-        // Copy the contents of the output SSBO into the intput SSBO
-        glBindBuffer(GL_COPY_READ_BUFFER, _outputParticleBuffer.GetBufferID());
-        glBindBuffer(GL_COPY_WRITE_BUFFER, _inputParticleBuffer.GetBufferID());
+    void SetParticleTransform(const glm::mat4& particleTransform)
+    {
+        _particleTransform = particleTransform;
 
-        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, sizeof(ComputeShaderParticle) * _numberOfParticles);
+        UploadEmitterParameters();
     };
 
 
-    void Draw() const
+    const EmitterBehaviour& GetBehaviour() const
     {
-        _particleShaderProgram.get().Bind();
-        glDrawArraysInstanced(GL_TRIANGLES, 0, 6, static_cast<std::uint32_t>(_particles.size()));
+        return _behaviour;
     };
 
-
-    void Destory()
+    /// <summary>
+    /// Change how this emitter's particles are spawned and drawn. 
+    /// Particles that already spawned keep their values until they reset
+    /// </summary>
+    /// <param name="behaviour"></param>
+    void SetBehaviour(const EmitterBehaviour& behaviour)
     {
-        _desrtoyRequested = true;
+        _behaviour = behaviour;
+
+        UploadEmitterParameters();
     };
 
 
-    glm::mat4& GetParticleEmmiterTransform()
+    std::uint32_t GetNumberOfParticles() const
     {
-        return _particleEmmiterTransform;
+        return _numberOfParticles;
     };
 
-    glm::mat4& GetParticleTransform()
+    /// <summary>
+    /// The index of this emitter's first particle inside the particle system's buffers. 
+    /// Not cached, the particle system moves emitters' particles when it compacts its buffers
+    /// </summary>
+    /// <returns></returns>
+    std::uint32_t GetFirstParticle() const
     {
-        return _particleTransform;
+        return _particleSystem.get().GetEmitterFirstParticle(_emitterIndex);
     };
 
-
-    bool GetDestroyed() const
+    std::uint32_t GetEmitterIndex() const
     {
-        if(_desrtoyRequested == true)
-        {
-            return _particles.empty();
-        };
-
-        return false;
+        return _emitterIndex;
     };
 
-
-private:
+    std::uint32_t GetSeed() const
+    {
+        return _seed;
+    };
 
     /// <summary>
-    /// Initialize a particle with some random data
+    /// The parameters the compute shaders see for this emitter
     /// </summary>
-    /// <param name="particle"></param>
-    /// <param name="particleIndex"></param>
-    void InitializeParticleValues(Particle& particle, const std::size_t particleIndex)
+    /// <returns></returns>
+    EmitterParameters GetEmitterParameters() const
     {
-        // I am not using C++'s random library because I want to match the expected results in GLSL
+        EmitterParameters emitterParameters = EmitterParameters::FromTransforms(_particleEmmiterTransform, _particleTransform, _seed, _behaviour);
 
+        emitterParameters.Draining = _desrtoyRequested ? 1 : 0;
 
-        // I have to use a "generator" here, if I don't then all the particles will be generated with values that are too close to each other
-        constexpr auto generateUV = []() -> glm::vec2
-        {
-            return { static_cast<float>(glfwGetTime()), 1.0f / static_cast<float>(glfwGetTime()) };
-        };
-
-        const float rngSeed = static_cast<float>(glfwGetTime());
-
-
-        const float newTrajectoryA = RandomNumberGenerator(generateUV(), rngSeed, 0.01f, 0.1f);
+        return emitterParameters;
+    };
 
 
-        // A very simple way of creating some trajectory direction variation
-        const float newTrajectoryB = (particleIndex & 1) == 1 ?
-            -RandomNumberGenerator(generateUV(), rngSeed, 4.4f, 4.5f) :
-            RandomNumberGenerator(generateUV(), rngSeed, 4.4f, 4.5f);
+    bool GetDestroyed() const
+    {
+        return _particleSystem.get().IsEmitterDrained(_emitterIndex);
+    };
 
 
-        // Correct the rate depending on trajectory direction
-        const float newRate = std::signbit(newTrajectoryB) == true ?
-            // "Left" trajectory 
-            -RandomNumberGenerator(generateUV(), rngSeed, 10.5f, 30.0f) :
-            // "Right" trajectory
-            RandomNumberGenerator(generateUV(), rngSeed, 10.5f, 30.0f);
+public:
 
+    ParticleEmmiter& operator = (const ParticleEmmiter&) = delete;
 
-        const float newOpacityDecreaseRate = RandomNumberGenerator(generateUV(), rngSeed, 0.05f, 0.1f);
 
+    ParticleEmmiter& operator = (ParticleEmmiter&& other) noexcept
+    {
+        if(this != &other)
+        {
+            if(_emitterIndex != InvalidEmitterIndex)
+                _particleSystem.get().FreeEmitter(_emitterIndex);
+
+            _numberOfParticles = other._numberOfParticles;
+            _particleSystem = other._particleSystem;
+            _emitterIndex = other._emitterIndex;
+            _seed = other._seed;
+            _particleEmmiterTransform = other._particleEmmiterTransform;
+            _particleTransform = other._particleTransform;
+            _behaviour = other._behaviour;
+            _desrtoyRequested = other._desrtoyRequested;
+
+            other._emitterIndex = InvalidEmitterIndex;
+        };
 
-        particle.TrajectoryA = newTrajectoryA;
-        particle.TrajectoryB = newTrajectoryB;
+        return *this;
+    };
 
-        particle.Trajectory = glm::vec2(0.0f);
-        particle.Rate = newRate;
 
-        particle.Opacity = 1.0f;
-        particle.OpacityDecreaseRate = newOpacityDecreaseRate;
+private:
 
-        // Apply custom particle transform
-        particle.Transform = _particleTransform;
+    /// <summary>
+    /// Write this emitter's transforms and behaviour to the particle system's emitter parameters. 
+    /// They reach the GPU with every other emitter's changes, on the particle system's next flush
+    /// </summary>
+    void UploadEmitterParameters()
+    {
+        _particleSystem.get().SetEmitterParameters(_emitterIndex, GetEmitterParameters());
     };
 
 };
@@ -0,0 +1,235 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <functional>
+#include <iostream>
+
+#include "ParticleEmitter.hpp"
+
+
+/// <summary>
+/// Refers to an emitter inside a ParticleEmitterPool.
+/// Once the emitter is destroyed the handle becomes invalid, even if its slot is reused by another emitter
+/// </summary>
+struct ParticleEmitterHandle
+{
+    static constexpr std::uint32_t InvalidSlot = static_cast<std::uint32_t>(-1);
+
+    std::uint32_t Slot = InvalidSlot;
+
+    /// <summary>
+    /// The generation of the slot when the emitter was created
+    /// </summary>
+    std::uint32_t Generation = 0;
+
+
+    bool operator == (const ParticleEmitterHandle&) const = default;
+};
+
+
+/// <summary>
+/// Owns every emitter of a particle system, as a generational slot map.
+/// Emitters are stored densely, in no particular order, so iterating them touches no gaps.
+/// Handles go through a slot that points into the dense storage, so emitters can be removed by swapping the last emitter into their place
+/// </summary>
+class ParticleEmitterPool
+{
+
+private:
+
+    /// <summary>
+    /// The indirection between a handle and its emitter
+    /// </summary>
+    struct Slot
+    {
+        /// <summary>
+        /// Incremented every time the slot's emitter is destroyed, which invalidates every handle to it
+        /// </summary>
+        std::uint32_t Generation = 0;
+
+        /// <summary>
+        /// The index of the slot's emitter inside the dense storage
+        /// </summary>
+        std::uint32_t DenseIndex = 0;
+    };
+
+
+    std::reference_wrapper<ParticleSystem> _particleSystem;
+
+    /// <summary>
+    /// Every live emitter, with no gaps. Reserved once, so creating an emitter never reallocates
+    /// </summary>
+    std::vector<ParticleEmmiter> _emitters;
+
+    /// <summary>
+    /// The slot of every emitter in _emitters, for fixing up a slot when its emitter is swapped
+    /// </summary>
+    std::vector<std::uint32_t> _denseSlots;
+
+    /// <summary>
+    /// One slot per emitter the particle system can hold
+    /// </summary>
+    std::vector<Slot> _slots;
+
+    /// <summary>
+    /// Slots of destroyed emitters that can be reused
+    /// </summary>
+    std::vector<std::uint32_t> _freeSlots;
+
+
+public:
+
+    ParticleEmitterPool(ParticleSystem& particleSystem) :
+        _particleSystem(particleSystem)
+    {
+        const std::uint32_t capacity = particleSystem.GetMaxNumberOfEmitters();
+
+        _emitters.reserve(capacity);
+        _denseSlots.reserve(capacity);
+        _slots.reserve(capacity);
+        _freeSlots.reserve(capacity);
+    };
+
+    ParticleEmitterPool(const ParticleEmitterPool&) = delete;
+
+
+public:
+
+    /// <summary>
+    /// Create an emitter with the particle system's default number of particles
+    /// </summary>
+    /// <param name="particleEmitterTransform"></param>
+    /// <returns></returns>
+    ParticleEmitterHandle Create(const glm::mat4& particleEmitterTransform)
+    {
+        return Create(particleEmitterTransform, _particleSystem.get().GetParticlesPerEmitter());
+    };
+
+    ParticleEmitterHandle Create(const glm::mat4& particleEmitterTransform, const std::uint32_t numberOfParticles)
+    {
+        if(_emitters.size() == _emitters.capacity())
+        {
+            std::cerr << "Emitter pool error: Unable to create more than " << _emitters.capacity() << " emitters\n";
+            __debugbreak();
+        };
+
+
+        std::uint32_t slotIndex = 0;
+
+        if(_freeSlots.empty() == false)
+        {
+            slotIndex = _freeSlots.back();
+            _freeSlots.pop_back();
+        }
+        else
+        {
+            slotIndex = static_cast<std::uint32_t>(_slots.size());
+            _slots.emplace_back();
+        };
+
+        Slot& slot = _slots[slotIndex];
+
+        slot.DenseIndex = static_cast<std::uint32_t>(_emitters.size());
+
+        _emitters.emplace_back(_particleSystem.get(), particleEmitterTransform, numberOfParticles);
+        _denseSlots.push_back(slotIndex);
+
+        return { .Slot = slotIndex, .Generation = slot.Generation };
+    };
+
+
+    /// <summary>
+    /// Destroy an emitter, its particle range is recycled by the particle system.
+    /// The last emitter is moved into its place, so references from Get() don't survive this call
+    /// </summary>
+    /// <param name="handle"></param>
+    void Destroy(const ParticleEmitterHandle handle)
+    {
+        if(IsValid(handle) == false)
+        {
+            std::cerr << "Emitter pool error: Invalid handle\n";
+            __debugbreak();
+            return;
+        };
+
+        Slot& slot = _slots[handle.Slot];
+
+        const std::uint32_t denseIndex = slot.DenseIndex;
+        const std::uint32_t lastDenseIndex = static_cast<std::uint32_t>(_emitters.size() - 1);
+
+        // Move-assigning over the emitter releases its emitter index
+        if(denseIndex != lastDenseIndex)
+        {
+            _emitters[denseIndex] = std::move(_emitters[lastDenseIndex]);
+            _denseSlots[denseIndex] = _denseSlots[lastDenseIndex];
+
+            _slots[_denseSlots[denseIndex]].DenseIndex = denseIndex;
+        };
+
+        _emitters.pop_back();
+        _denseSlots.pop_back();
+
+
+        slot.Generation++;
+
+        _freeSlots.push_back(handle.Slot);
+    };
+
+
+    bool IsValid(const ParticleEmitterHandle handle) const
+    {
+        return (handle.Slot < _slots.size()) &&
+               (_slots[handle.Slot].Generation == handle.Generation);
+    };
+
+
+    /// <summary>
+    /// Get a handle's emitter. The reference is valid until the next Create() or Destroy()
+    /// </summary>
+    /// <param name="handle"> Must be valid </param>
+    /// <returns></returns>
+    ParticleEmmiter& Get(const ParticleEmitterHandle handle)
+    {
+        return _emitters[_slots[handle.Slot].DenseIndex];
+    };
+
+    const ParticleEmmiter& Get(const ParticleEmitterHandle handle) const
+    {
+        return _emitters[_slots[handle.Slot].DenseIndex];
+    };
+
+
+    /// <summary>
+    /// Call a function for every live emitter. The function may destroy the emitter it was called with, but must not use it afterwards.
+    /// Emitters are visited from the back, so the emitter that is swapped into a destroyed emitter's place was already visited
+    /// </summary>
+    /// <typeparam name="TFunction"> A function of (ParticleEmitterHandle, ParticleEmmiter&) </typeparam>
+    /// <param name="function"></param>
+    template<typename TFunction>
+    void ForEach(TFunction&& function)
+    {
+        for(std::size_t denseIndex = _emitters.size(); denseIndex > 0; denseIndex--)
+        {
+            const std::uint32_t slotIndex = _denseSlots[denseIndex - 1];
+
+            const ParticleEmitterHandle handle = { .Slot = slotIndex, .Generation = _slots[slotIndex].Generation };
+
+            function(handle, _emitters[denseIndex - 1]);
+        };
+    };
+
+
+public:
+
+    std::uint32_t GetNumberOfEmitters() const
+    {
+        return static_cast<std::uint32_t>(_emitters.size());
+    };
+
+
+public:
+
+    ParticleEmitterPool& operator = (const ParticleEmitterPool&) = delete;
+
+};
\ No newline at end of file
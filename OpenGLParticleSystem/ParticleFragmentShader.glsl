@@ -1,18 +1,19 @@
 #version 430 core
 
-in vec2 VertexShaderTextureCoordinateOutput;
+// (U, V, Sprite array layer)
+in vec3 VertexShaderTextureCoordinateOutput;
 in float VertexShaderOpacityOutput;
-flat in uint VertexShaderTextureUnitOutput;
 
 
-uniform sampler2D Textures[3];
+// Every sprite is a layer, so particles with different sprites sample the same texture
+uniform sampler2DArray Sprites;
 
 out vec4 OutputColour;
 
 
 void main()
 {
-    OutputColour = texture(Textures[VertexShaderTextureUnitOutput], VertexShaderTextureCoordinateOutput);
+    OutputColour = texture(Sprites, VertexShaderTextureCoordinateOutput);
     
     // Subtract 1 from opacity so we subtract the correct quantity from the pixel's alpha
     const float opacity = 1.0f - clamp(VertexShaderOpacityOutput, 0.0f, 1.0f);
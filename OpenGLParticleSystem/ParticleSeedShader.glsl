@@ -0,0 +1,58 @@
+#version 430
+
+layout(local_size_x = 64) in;
+
+
+#include "ParticleShaderCommon.glsl"
+
+
+// A range of particles that belongs to a newly created emitter
+struct SeedRequest
+{
+    uint FirstParticle;
+    uint NumberOfParticles;
+
+    uint EmitterIndex;
+};
+
+
+layout(std430, binding = 0) writeonly buffer OutParticlesBuffer
+{
+    Particle OutParticles[];
+};
+
+layout(std430, binding = 3) readonly buffer EmittersBuffer
+{
+    Emitter Emitters[];
+};
+
+layout(std430, binding = 4) readonly buffer SeedRequestsBuffer
+{
+    SeedRequest SeedRequests[];
+};
+
+
+
+// Keys the random streams of the seeded particles
+uniform uint Frame;
+
+
+
+// Every work group row (gl_WorkGroupID.y) seeds the particles of a single request
+void main()
+{
+    const SeedRequest seedRequest = SeedRequests[gl_WorkGroupID.y];
+
+    // The dispatch is sized for the largest request
+    if(gl_GlobalInvocationID.x >= seedRequest.NumberOfParticles)
+        return;
+
+    const uint particleIndex = seedRequest.FirstParticle + gl_GlobalInvocationID.x;
+
+    Particle particle;
+    particle.EmitterIndex = seedRequest.EmitterIndex;
+
+    InitializeParticleValues(particle, particleIndex, Emitters[seedRequest.EmitterIndex], Frame);
+
+    OutParticles[particleIndex] = particle;
+};
\ No newline at end of file
@@ -0,0 +1,161 @@
+// Definitions shared by every particle shader. 
+// Shaders include this file after their '#version' directive, see ReadShaderSource in ComputeShaderProgram.hpp and ShaderProgram.hpp
+
+
+// Must match ComputeShaderParticle in Particle.hpp
+struct Particle
+{
+    // The Y position is calculated from it
+    float TrajectoryX;
+
+    float Opacity;
+
+    // packHalf2x16(TrajectoryA, TrajectoryB), only changes when the particle resets
+    uint PackedTrajectory;
+
+    // packHalf2x16(Rate, OpacityDecreaseRate), only changes when the particle resets
+    uint PackedRates;
+
+    uint EmitterIndex;
+};
+
+
+// How an emitter's particles are spawned and drawn. Must match EmitterBehaviour in Particle.hpp
+struct EmitterBehaviour
+{
+    // The (min, max) ranges a particle's values are drawn from whenever it resets
+    vec2 TrajectoryARange;
+    vec2 TrajectoryBRange;
+    vec2 RateRange;
+    vec2 OpacityDecreaseRateRange;
+
+    // The emitter's particles cycle through NumberOfSprites sprites, starting at FirstSprite. 0 sprites means every sprite, and FirstSprite is ignored
+    uint FirstSprite;
+    uint NumberOfSprites;
+
+    uint Flags;
+};
+
+// Even particles go left and odd particles go right
+const uint AlternateDirectionsFlag = 1u << 0u;
+
+// When directions don't alternate, every particle goes left instead of right
+const uint LeftDirectionFlag = 1u << 1u;
+
+
+// Must match EmitterParameters in Particle.hpp
+struct Emitter
+{
+    // Where, in NDC, a particle at the start of its trajectory is drawn
+    vec2 Origin;
+
+    // How far, in NDC, a particle moves per unit of scaled NDC trajectory along X and Y
+    vec2 AxisX;
+    vec2 AxisY;
+
+    // Half the size of a particle's quad, in NDC
+    float Scale;
+
+    uint Active;
+
+    uint Seed;
+
+    // Particles of a draining emitter don't reset, and are counted until every one of them faded out
+    uint Draining;
+
+    EmitterBehaviour Behaviour;
+};
+
+
+
+// A counter-based random number stream. 
+// Streams are keyed by (seed, emitter, particle, frame), so particles can be initialized in parallel, in any order, and with the same results on every run.
+// Must stay identical to the implementation in Math.hpp
+struct RandomStream
+{
+    uint Key;
+
+    // The number of values that were taken from this stream
+    uint Counter;
+};
+
+
+// PCG hash, from "Hash Functions for GPU Rendering" (Jarzynski and Olano, 2020)
+uint PcgHash(uint value)
+{
+    const uint state = value * 747796405u + 2891336453u;
+    const uint word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+
+    return (word >> 22u) ^ word;
+};
+
+
+RandomStream CreateRandomStream(uint seed, uint emitterIndex, uint particleIndex, uint frame)
+{
+    return RandomStream(PcgHash(seed ^ PcgHash(emitterIndex ^ PcgHash(particleIndex ^ PcgHash(frame)))), 0u);
+};
+
+
+// Take the next number, in [0, 1), from a stream
+float RandomNumberGenerator(inout RandomStream stream)
+{
+    const uint bits = PcgHash(stream.Key + stream.Counter);
+
+    stream.Counter++;
+
+    // 24 bits fit exactly in a float, so the result is the same on the CPU and the GPU
+    return float(bits >> 8u) * (1.0f / 16777216.0f);
+};
+
+
+float RandomNumberGenerator(inout RandomStream stream, float min, float max)
+{
+    const float rng = RandomNumberGenerator(stream);
+    
+    // Map [0, 1) to [min, max). 
+    // 'precise' keeps the compiler from fusing this into an fma, which rounds differently than the C++ version
+    precise float rngResult = min + rng * (max - min);
+
+    return rngResult;
+};
+
+
+// Every particle draws its values from its own stream, in the same order as CpuParticleSimulation::ResetParticle
+void InitializeParticleValues(inout Particle particle, uint particleIndex, Emitter emitter, uint frame)
+{
+    RandomStream stream = CreateRandomStream(emitter.Seed, particle.EmitterIndex, particleIndex, frame);
+
+
+    const EmitterBehaviour behaviour = emitter.Behaviour;
+
+    const bool left = ((behaviour.Flags & AlternateDirectionsFlag) != 0u) ?
+        // A very simple way of creating some trajectory variation
+        ((particleIndex % 2) == 0) :
+        ((behaviour.Flags & LeftDirectionFlag) != 0u);
+
+
+    const float newTrajectoryA = RandomNumberGenerator(stream, behaviour.TrajectoryARange.x, behaviour.TrajectoryARange.y);
+
+    const float newTrajectoryB = left ?
+        -RandomNumberGenerator(stream, behaviour.TrajectoryBRange.x, behaviour.TrajectoryBRange.y) :
+        RandomNumberGenerator(stream, behaviour.TrajectoryBRange.x, behaviour.TrajectoryBRange.y);
+
+
+    // Correct the rate depending on trajectory direction
+    const float newRate = left ?
+        // "Left" trajectory 
+        -RandomNumberGenerator(stream, behaviour.RateRange.x, behaviour.RateRange.y) :
+        // "Right" trajectory
+        RandomNumberGenerator(stream, behaviour.RateRange.x, behaviour.RateRange.y);
+
+
+    const float newOpacityDecreaseRate = RandomNumberGenerator(stream, behaviour.OpacityDecreaseRateRange.x, behaviour.OpacityDecreaseRateRange.y);
+
+
+
+    particle.TrajectoryX = 0.0f;
+    particle.Opacity = 1.0f;
+
+    particle.PackedTrajectory = packHalf2x16(vec2(newTrajectoryA, newTrajectoryB));
+    particle.PackedRates = packHalf2x16(vec2(newRate, newOpacityDecreaseRate));
+};
\ No newline at end of file
@@ -0,0 +1,1566 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <functional>
+#include <glad/glad.h>
+
+#include "ShaderProgram.hpp"
+#include "VertexArray.hpp"
+#include "SpriteSheet.hpp"
+#include "ShaderStorageBuffer.hpp"
+#include "ComputeShaderProgram.hpp"
+#include "ComputeDispatchBatch.hpp"
+#include "DrawIndirectBuffer.hpp"
+#include "StreamingBuffer.hpp"
+#include "ParticleArena.hpp"
+#include "Math.hpp"
+#include "Particle.hpp"
+
+
+// Defined in Main.cpp
+extern int WindowWidth;
+extern int WindowHeight;
+
+
+
+/// <summary>
+/// Owns the GPU storage of every emitter's particles.
+/// All particles live in one set of SSBOs, and every emitter owns a range of them sub-allocated by a ParticleArena,
+/// so the whole scene can be updated with a single dispatch and drawn with a single draw call
+/// </summary>
+class ParticleSystem
+{
+
+private:
+
+    /// <summary>
+    /// The size of each frame's region of the streaming buffer, which per-frame CPU data passes through on its way to the GPU
+    /// </summary>
+    static constexpr std::size_t StreamingRegionSizeInBytes = 4 * 1024 * 1024;
+
+    /// <summary>
+    /// Every particle is drawn as a quad of 2 triangles. 
+    /// The vertex shader pulls a particle's data by gl_VertexID, so no vertex attributes are needed
+    /// </summary>
+    static constexpr std::uint32_t VerticesPerParticle = 6;
+
+    /// <summary>
+    /// The fraction of the updated particles that may sit in holes left by freed emitters before the arena is compacted
+    /// </summary>
+    static constexpr float MaxArenaFragmentation = 0.25f;
+
+    /// <summary>
+    /// How many freed ranges of the same size are kept for new emitters, before freed ranges go back to the arena
+    /// </summary>
+    static constexpr std::size_t MaxRecycledRangesPerSize = 64;
+
+    /// <summary>
+    /// How this frame's updated particles are consumed: 
+    /// Drawn, read by the next frame's compute shader, and copied by compaction and by readbacks
+    /// </summary>
+    static constexpr GLbitfield UpdateBarrierBits = GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT;
+
+    /// <summary>
+    /// How seeded particles are consumed: Updated by the compute shader, and overwritten by queued uploads
+    /// </summary>
+    static constexpr GLbitfield SeedBarrierBits = GL_SHADER_STORAGE_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT;
+
+    /// <summary>
+    /// The drain start frame of an emitter that isn't draining
+    /// </summary>
+    static constexpr std::uint32_t NotDraining = static_cast<std::uint32_t>(-1);
+
+    /// <summary>
+    /// The pending seed request index of an emitter that has none
+    /// </summary>
+    static constexpr std::uint32_t NoSeedRequest = static_cast<std::uint32_t>(-1);
+
+
+    /// <summary>
+    /// A range of particles waiting in _pendingParticles to be uploaded
+    /// </summary>
+    struct PendingParticleUpload
+    {
+        std::uint32_t FirstParticle = 0;
+        std::uint32_t NumberOfParticles = 0;
+    };
+
+    /// <summary>
+    /// The uniform buffer binding point of the SceneUniforms block
+    /// </summary>
+    static constexpr std::uint32_t SceneUniformsBinding = 0;
+
+    /// <summary>
+    /// The texture unit the sprite array is bound to
+    /// </summary>
+    static constexpr int SpritesTextureUnit = 0;
+
+
+    /// <summary>
+    /// The uniforms of the transform compute shader, found again whenever the shader is replaced. 
+    /// Everything that is the same for every dispatch of a frame is in the SceneUniforms block instead
+    /// </summary>
+    struct ComputeUniformHandles
+    {
+        UniformHandle<std::uint32_t> FirstParticle;
+        UniformHandle<std::uint32_t> NumberOfParticles;
+    };
+
+    /// <summary>
+    /// A frame's alive counts, on their way back from the GPU
+    /// </summary>
+    struct AliveCountReadback
+    {
+        AsyncBufferReadback Readback;
+
+        /// <summary>
+        /// The frame the counts were taken at
+        /// </summary>
+        std::uint32_t Frame = 0;
+
+        /// <summary>
+        /// Were the counts already looked at
+        /// </summary>
+        bool Consumed = true;
+    };
+
+
+    /// <summary>
+    /// The maximum number of emitters that can exist at the same time
+    /// </summary>
+    std::uint32_t _maxNumberOfEmitters;
+
+    /// <summary>
+    /// The number of particles an emitter owns by default. The particle buffers are sized for this many per emitter
+    /// </summary>
+    std::uint32_t _particlesPerEmitter;
+
+    float _particleScaleFactor;
+
+    /// <summary>
+    /// How many frames the CPU may submit before the GPU finishes them, see FramePacer. 
+    /// The alive count readbacks have one copy per frame in flight. 
+    /// The streaming buffer has one region more, it rotates mid-frame in SwapParticleBuffers() rather than on the pacer's frame boundary
+    /// </summary>
+    std::uint32_t _framesInFlight;
+
+
+    /// <summary>
+    /// A reference to the shader program which will draw the particles
+    /// </summary>
+    std::reference_wrapper<const ShaderProgram> _particleShaderProgram;
+
+    /// <summary>
+    /// A reference to a particle transform compute shader
+    /// </summary>
+    std::reference_wrapper<const ComputeShaderProgram> _computeShaderProgram;
+
+    /// <summary>
+    /// The number of particles a work group of the transform compute shader updates, its work group size times its particles per invocation
+    /// </summary>
+    std::uint32_t _particlesPerWorkGroup = 0;
+
+    /// <summary>
+    /// A reference to the compute shader which writes the initial particles of new emitters
+    /// </summary>
+    std::reference_wrapper<const ComputeShaderProgram> _seedShaderProgram;
+
+    /// <summary>
+    /// An empty VAO for the particles, core profile draws require one to be bound
+    /// </summary>
+    std::reference_wrapper<const VertexArray> _particleVAO;
+
+    /// <summary>
+    /// Every particle sprite, in a single texture array
+    /// </summary>
+    std::reference_wrapper<const SpriteSheet> _particleSprites;
+
+
+    ComputeUniformHandles _computeUniforms;
+
+    UniformHandle<std::uint32_t> _seedFrameUniform;
+
+
+
+    /// <summary>
+    /// The scene uniforms of the current frame, once they were written to the streaming buffer
+    /// </summary>
+    SceneUniforms _sceneUniforms;
+
+    bool _sceneUniformsWritten = false;
+
+    /// <summary>
+    /// Set by SwapParticleBuffers() when the arena is too fragmented. 
+    /// The compaction waits for the next frame's first update, since this frame's instances were already written at the particles' old positions
+    /// </summary>
+    bool _compactionRequested = false;
+
+    /// <summary>
+    /// GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, for binding the scene uniforms from the streaming buffer
+    /// </summary>
+    std::size_t _uniformBufferOffsetAlignment = 0;
+
+
+    /// <summary>
+    /// Two SSBOs of particle data. Every frame the compute shader reads one of them and writes the other, 
+    /// and then they swap roles, so the output never has to be copied back into the input
+    /// </summary>
+    ShaderStorageBuffer _particleBuffers[2];
+
+    /// <summary>
+    /// The index of the particle buffer the compute shader reads from this frame
+    /// </summary>
+    std::uint32_t _inputParticleBufferIndex = 0;
+
+    /// <summary>
+    /// An output SSBO of a vec4 per particle, (NDC position, Scale, Opacity)
+    /// </summary>
+    ShaderStorageBuffer _outputParticleInstancesBuffer;
+
+    /// <summary>
+    /// An SSBO of EmitterParameters, indexed by a particle's EmitterIndex
+    /// </summary>
+    ShaderStorageBuffer _emitterParametersBuffer;
+
+    /// <summary>
+    /// A CPU copy of the emitter parameters buffer. Emitters change their parameters here, 
+    /// and the span of emitter indices that changed is uploaded with a single copy before the next dispatch reads it
+    /// </summary>
+    std::vector<EmitterParameters> _emitterParameters;
+
+    /// <summary>
+    /// The span of emitter indices whose parameters changed since the last upload. Empty if both are equal
+    /// </summary>
+    std::uint32_t _firstDirtyEmitter = 0;
+    std::uint32_t _endDirtyEmitter = 0;
+
+    /// <summary>
+    /// The number of emitter parameter bytes uploaded during the current and the last frame
+    /// </summary>
+    std::size_t _currentFrameEmitterUploadBytes = 0;
+    std::size_t _lastFrameEmitterUploadBytes = 0;
+
+    /// <summary>
+    /// One draw command per emitter index. Freed emitters have a command with no instances
+    /// </summary>
+    DrawIndirectBuffer _drawCommandsBuffer;
+
+    /// <summary>
+    /// An SSBO of a counter per emitter index. The compute shader counts the live particles of every draining emitter in it
+    /// </summary>
+    ShaderStorageBuffer _aliveCountsBuffer;
+
+    /// <summary>
+    /// One readback per frame in flight. 
+    /// A frame's counts arrive by the time its slot comes around again, so a readback is always free
+    /// </summary>
+    std::vector<AliveCountReadback> _aliveCountReadbacks;
+
+    /// <summary>
+    /// The readback the next frame's alive counts are copied to
+    /// </summary>
+    std::uint32_t _nextAliveCountReadback = 0;
+
+    /// <summary>
+    /// The first frame whose alive count is trusted for every emitter index, or NotDraining
+    /// </summary>
+    std::vector<std::uint32_t> _drainStartFrames;
+
+    /// <summary>
+    /// Emitter indices whose particles all faded out after they started draining
+    /// </summary>
+    std::vector<std::uint8_t> _drainedEmitters;
+
+    std::uint32_t _numberOfDrainingEmitters = 0;
+
+
+    /// <summary>
+    /// Every update dispatch of the current frame. They write separate ranges of particles, so they share a single barrier before the particles are drawn
+    /// </summary>
+    ComputeDispatchBatch _updateDispatches;
+
+    /// <summary>
+    /// Seed dispatches of the current flush, one per batch of requests
+    /// </summary>
+    ComputeDispatchBatch _seedDispatches;
+
+
+    /// <summary>
+    /// Emitters that were created since the last flush, and whose particles still need to be initialized
+    /// </summary>
+    std::vector<EmitterSeedRequest> _pendingSeedRequests;
+
+    /// <summary>
+    /// Where every emitter's request is inside _pendingSeedRequests, so a freed emitter's request is dropped without searching for it
+    /// </summary>
+    std::vector<std::uint32_t> _pendingSeedRequestIndices;
+
+    /// <summary>
+    /// The number of seeds that were handed out to emitters
+    /// </summary>
+    std::uint32_t _emitterSeedCounter = 0;
+
+    /// <summary>
+    /// The number of times the particle buffers were swapped. Keys the random streams of particles that are seeded or reset
+    /// </summary>
+    std::uint32_t _frame = 0;
+
+
+    /// <summary>
+    /// Particle data of every upload that was queued since the last flush, stored contiguously in queue order
+    /// </summary>
+    std::vector<ComputeShaderParticle> _pendingParticles;
+
+    /// <summary>
+    /// Where every queued upload should end up
+    /// </summary>
+    std::vector<PendingParticleUpload> _pendingParticleUploads;
+
+    /// <summary>
+    /// Every per-frame CPU write goes through here: 
+    /// Queued particles and emitter parameters are copied from it on the GPU, and the seeding shader reads its requests from it directly
+    /// </summary>
+    StreamingBuffer _streamingBuffer;
+
+    /// <summary>
+    /// GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, for binding ranges of the streaming buffer as SSBOs
+    /// </summary>
+    std::size_t _storageBufferOffsetAlignment = 0;
+
+
+    /// <summary>
+    /// Emitter indices that were released and can be reused
+    /// </summary>
+    std::vector<std::uint32_t> _freeEmitterIndices;
+
+    /// <summary>
+    /// One past the highest emitter index that was ever allocated. Every draw command below it is drawn
+    /// </summary>
+    std::uint32_t _emitterIndexWatermark = 0;
+
+    /// <summary>
+    /// Hands out the ranges of particles emitters own inside the particle buffers
+    /// </summary>
+    ParticleArena _particleArena;
+
+    /// <summary>
+    /// The range of particles every emitter index owns. Ranges move when the arena is compacted
+    /// </summary>
+    std::vector<ParticleArena::Block> _emitterParticleRanges;
+
+    /// <summary>
+    /// Ranges of destroyed emitters, bucketed by their number of particles. 
+    /// They stay allocated in the arena, so spawning an emitter the size of one that was just destroyed takes its range over as is
+    /// </summary>
+    std::unordered_map<std::uint32_t, std::vector<ParticleArena::Block>> _recycledParticleRanges;
+
+    /// <summary>
+    /// The number of particles in every recycled range
+    /// </summary>
+    std::uint32_t _recycledParticles = 0;
+
+
+    /// <summary>
+    /// The number of bytes that would have been copied from the output to the input particle buffer this frame
+    /// </summary>
+    std::size_t _currentFrameSavedCopyBytes = 0;
+
+    /// <summary>
+    /// The number of bytes that would have been copied during the last frame
+    /// </summary>
+    std::size_t _lastFrameSavedCopyBytes = 0;
+
+
+public:
+
+    ParticleSystem(const std::uint32_t maxNumberOfEmitters,
+                   const std::uint32_t particlesPerEmitter,
+                   const float particleScaleFactor,
+                   const std::uint32_t framesInFlight,
+                   const ShaderProgram& shaderProgram,
+                   const ComputeShaderProgram& computeShaderProgram,
+                   const ComputeShaderProgram& seedShaderProgram,
+                   const VertexArray& particleVAO,
+                   const SpriteSheet& sprites) :
+        _maxNumberOfEmitters(maxNumberOfEmitters),
+        _particlesPerEmitter(particlesPerEmitter),
+        _particleScaleFactor(particleScaleFactor),
+        _framesInFlight(framesInFlight),
+        _particleShaderProgram(shaderProgram),
+        _computeShaderProgram(computeShaderProgram),
+        _seedShaderProgram(seedShaderProgram),
+        _particleVAO(particleVAO),
+        _particleSprites(sprites),
+        _particleBuffers
+        {
+            ShaderStorageBuffer(nullptr, sizeof(ComputeShaderParticle) * GetMaxNumberOfParticles(), 0, GL_DYNAMIC_COPY),
+            ShaderStorageBuffer(nullptr, sizeof(ComputeShaderParticle) * GetMaxNumberOfParticles(), 1, GL_DYNAMIC_COPY),
+        },
+        _outputParticleInstancesBuffer(nullptr, sizeof(glm::vec4) * GetMaxNumberOfParticles(), 2),
+        _emitterParametersBuffer(nullptr, sizeof(EmitterParameters) * (maxNumberOfEmitters + 1), 3, GL_DYNAMIC_DRAW),
+        // Every emitter starts inactive, including the extra one that particles outside of any emitter's range belong to
+        _emitterParameters(maxNumberOfEmitters + 1),
+        _drawCommandsBuffer(maxNumberOfEmitters),
+        _aliveCountsBuffer(nullptr, sizeof(std::uint32_t) * (maxNumberOfEmitters + 1), 5, GL_DYNAMIC_COPY),
+        _drainStartFrames(maxNumberOfEmitters, NotDraining),
+        _drainedEmitters(maxNumberOfEmitters, 0),
+        _pendingSeedRequestIndices(maxNumberOfEmitters, NoSeedRequest),
+        _streamingBuffer(StreamingRegionSizeInBytes, framesInFlight + 1),
+        _particleArena(GetMaxNumberOfParticles()),
+        _emitterParticleRanges(maxNumberOfEmitters)
+    {
+        GLint storageBufferOffsetAlignment = 0;
+        glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &storageBufferOffsetAlignment);
+
+        _storageBufferOffsetAlignment = static_cast<std::size_t>(storageBufferOffsetAlignment);
+
+        GLint uniformBufferOffsetAlignment = 0;
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniformBufferOffsetAlignment);
+
+        _uniformBufferOffsetAlignment = static_cast<std::size_t>(uniformBufferOffsetAlignment);
+
+
+        SetComputeShaderProgram(computeShaderProgram);
+
+        _seedFrameUniform = seedShaderProgram.GetUniformHandle<std::uint32_t>("Frame");
+
+        // The sprite array is always bound to the first texture unit
+        shaderProgram.SetUniform(shaderProgram.GetUniformHandle<int>("Sprites"), SpritesTextureUnit);
+
+
+        _emitterParametersBuffer.Bind();
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(EmitterParameters) * _emitterParameters.size(), _emitterParameters.data());
+
+        ClearParticles(0, GetMaxNumberOfParticles());
+
+        ClearAliveCounts();
+
+        _aliveCountReadbacks.reserve(framesInFlight);
+
+        for(std::uint32_t i = 0; i < framesInFlight; i++)
+            _aliveCountReadbacks.push_back({ .Readback = AsyncBufferReadback(GetAliveCountsSizeInBytes()) });
+
+    };
+
+
+    ParticleSystem(const ParticleSystem&) = delete;
+
+
+public:
+
+    /// <summary>
+    /// Reserve an emitter index, and with it a range of particles
+    /// </summary>
+    /// <param name="numberOfParticles"></param>
+    /// <returns></returns>
+    std::uint32_t AllocateEmitter(const std::uint32_t numberOfParticles)
+    {
+        std::uint32_t emitterIndex = 0;
+
+        if(_freeEmitterIndices.empty() == false)
+        {
+            emitterIndex = _freeEmitterIndices.back();
+            _freeEmitterIndices.pop_back();
+        }
+        else
+        {
+            if(_emitterIndexWatermark == _maxNumberOfEmitters)
+            {
+                std::cerr << "Particle system error: Unable to allocate more than " << _maxNumberOfEmitters << " emitters\n";
+                __debugbreak();
+            };
+
+            emitterIndex = _emitterIndexWatermark++;
+        };
+
+
+        ParticleArena::Block particleRange;
+
+        if((TakeRecycledParticleRange(numberOfParticles, particleRange) == false) &&
+           (_particleArena.Allocate(numberOfParticles, particleRange) == false))
+        {
+            // There may be enough room in the holes and recycled ranges freed emitters left behind. 
+            // Emitters are created between updates, so the particle buffers can be moved around
+            CompactParticles();
+
+            if(_particleArena.Allocate(numberOfParticles, particleRange) == false)
+            {
+                std::cerr << "Particle system error: Unable to allocate " << numberOfParticles << " particles, " 
+                    << _particleArena.GetStatistics().AllocatedParticles << " out of " << GetMaxNumberOfParticles() << " are in use\n";
+                __debugbreak();
+            };
+        };
+
+        _emitterParticleRanges[emitterIndex] = particleRange;
+
+        SetDrawCommand(emitterIndex);
+
+        return emitterIndex;
+    };
+
+    /// <summary>
+    /// Release an emitter index and its range of particles. The range is kept for the next emitter of the same size
+    /// </summary>
+    /// <param name="emitterIndex"></param>
+    void FreeEmitter(const std::uint32_t emitterIndex)
+    {
+        SetEmitterParameters(emitterIndex, EmitterParameters());
+
+        // An empty command, so the emitter's particles aren't drawn at all
+        WriteDrawCommand(emitterIndex, DrawArraysIndirectCommand());
+
+
+        const ParticleArena::Block& particleRange = _emitterParticleRanges[emitterIndex];
+
+        // A queued seed of the range would be cleared right away, so it's dropped instead of dispatched. 
+        // Queued uploads are packed together, one that targets the range has to land before the range is cleared
+        DropSeedRequest(emitterIndex);
+
+        const bool uploadPending = std::any_of(_pendingParticleUploads.cbegin(), _pendingParticleUploads.cend(), [&particleRange](const PendingParticleUpload& upload)
+        {
+            return Overlaps(particleRange, upload.FirstParticle, upload.NumberOfParticles);
+        });
+
+        if(uploadPending == true)
+            FlushPendingParticles();
+
+        // The range may be handed to another emitter, and the emitter index may be reused with a different range. 
+        // Either way, the particles must not be picked up by whichever emitter uses the index next
+        ClearParticles(particleRange.FirstParticle, particleRange.NumberOfParticles);
+
+        std::vector<ParticleArena::Block>& recycledRanges = _recycledParticleRanges[particleRange.NumberOfParticles];
+
+        if(recycledRanges.size() < MaxRecycledRangesPerSize)
+        {
+            recycledRanges.push_back(particleRange);
+            _recycledParticles += particleRange.NumberOfParticles;
+        }
+        else
+            _particleArena.Free(particleRange);
+
+        _emitterParticleRanges[emitterIndex] = ParticleArena::Block();
+
+
+        if(_drainStartFrames[emitterIndex] != NotDraining)
+            _numberOfDrainingEmitters--;
+
+        _drainStartFrames[emitterIndex] = NotDraining;
+        _drainedEmitters[emitterIndex] = 0;
+
+        _freeEmitterIndices.push_back(emitterIndex);
+    };
+
+
+    /// <summary>
+    /// Start counting an emitter's live particles. 
+    /// The emitter's parameters must be set as draining before the next update, so its particles stop resetting
+    /// </summary>
+    /// <param name="emitterIndex"></param>
+    void DrainEmitter(const std::uint32_t emitterIndex)
+    {
+        if(_drainStartFrames[emitterIndex] != NotDraining)
+            return;
+
+        // The current frame's range may have been updated before the emitter started draining, and then it wasn't counted
+        _drainStartFrames[emitterIndex] = _frame + 1;
+
+        _numberOfDrainingEmitters++;
+    };
+
+    /// <summary>
+    /// Did every particle of a draining emitter fade out. 
+    /// Known a few frames after the fact, once the alive counts make their way back from the GPU
+    /// </summary>
+    /// <param name="emitterIndex"></param>
+    /// <returns></returns>
+    bool IsEmitterDrained(const std::uint32_t emitterIndex) const
+    {
+        return _drainedEmitters[emitterIndex] != 0;
+    };
+
+
+    /// <summary>
+    /// Get a seed for a new emitter. Seeds are handed out in a fixed order, so runs are reproducible
+    /// </summary>
+    /// <returns></returns>
+    std::uint32_t GenerateEmitterSeed()
+    {
+        return PcgHash(_emitterSeedCounter++);
+    };
+
+
+    /// <summary>
+    /// Initialize a range of particles on the GPU, from the emitter's seed and parameters, on the next FlushPendingParticles().
+    /// The emitter's parameters must be set before then
+    /// </summary>
+    /// <param name="emitterIndex"></param>
+    /// <param name="firstParticle"></param>
+    /// <param name="numberOfParticles"></param>
+    void SeedEmitter(const std::uint32_t emitterIndex, const std::uint32_t firstParticle, const std::uint32_t numberOfParticles)
+    {
+        const EmitterSeedRequest seedRequest =
+        {
+            .FirstParticle = firstParticle,
+            .NumberOfParticles = numberOfParticles,
+            .EmitterIndex = emitterIndex,
+        };
+
+        // Seeding an emitter again before the flush replaces its request
+        if(_pendingSeedRequestIndices[emitterIndex] != NoSeedRequest)
+        {
+            _pendingSeedRequests[_pendingSeedRequestIndices[emitterIndex]] = seedRequest;
+            return;
+        };
+
+        _pendingSeedRequestIndices[emitterIndex] = static_cast<std::uint32_t>(_pendingSeedRequests.size());
+
+        _pendingSeedRequests.push_back(seedRequest);
+    };
+
+
+    /// <summary>
+    /// Reserve room for particle data that will be uploaded to the input particle buffer on the next FlushPendingParticles().
+    /// Meant for particle state that was built on the CPU, new emitters are seeded with SeedEmitter() instead.
+    /// The returned pointer is only valid until the next call to this function
+    /// </summary>
+    /// <param name="firstParticle"> Where the particles should be uploaded to </param>
+    /// <param name="numberOfParticles"></param>
+    /// <returns> A pointer to numberOfParticles particles which should be filled </returns>
+    ComputeShaderParticle* QueueParticleUpload(const std::uint32_t firstParticle, const std::uint32_t numberOfParticles)
+    {
+        const std::size_t offset = _pendingParticles.size();
+
+        _pendingParticles.resize(offset + numberOfParticles);
+
+        _pendingParticleUploads.push_back({ .FirstParticle = firstParticle, .NumberOfParticles = numberOfParticles });
+
+        return _pendingParticles.data() + offset;
+    };
+
+
+    /// <summary>
+    /// Upload the emitter parameters that changed, seed every new emitter, and then upload every queued range of particles, so uploads overwrite seeded particles.
+    /// Called by UpdateRange(), so it's only needed when the input particle buffer must be up to date before an update
+    /// </summary>
+    void FlushPendingParticles()
+    {
+        FlushEmitterParameters();
+        FlushSeedRequests();
+        FlushParticleUploads();
+    };
+
+
+    /// <summary>
+    /// Update particles with a different variant of the transform compute shader, for example one picked by a ComputeShaderAutoTuner. 
+    /// Bind() must be called afterwards, uniforms are set per program. Not meant to be called every frame, the shader's uniforms are looked up by name
+    /// </summary>
+    /// <param name="computeShaderProgram"></param>
+    void SetComputeShaderProgram(const ComputeShaderProgram& computeShaderProgram)
+    {
+        // The static checks in Particle.hpp only cover the C++ side
+        CheckParticleLayout(computeShaderProgram);
+
+        _computeShaderProgram = computeShaderProgram;
+
+        _computeUniforms =
+        {
+            .FirstParticle = computeShaderProgram.GetUniformHandle<std::uint32_t>("FirstParticle"),
+            .NumberOfParticles = computeShaderProgram.GetUniformHandle<std::uint32_t>("NumberOfParticles"),
+        };
+
+        // Must match the shader's own default
+        constexpr std::uint32_t defaultParticlesPerInvocation = 1;
+
+        _particlesPerWorkGroup = computeShaderProgram.GetWorkGroupSize()[0] * computeShaderProgram.GetDefineValue("PARTICLES_PER_INVOCATION", defaultParticlesPerInvocation);
+    };
+
+
+    /// <summary>
+    /// Draw particles with a different sprite sheet, for example one an AsyncSpriteLoader started loading mid-session. 
+    /// Bind() must be called afterwards. Every emitter's sprites must exist in the new sheet, and the sheet must outlive its use
+    /// </summary>
+    /// <param name="sprites"></param>
+    void SetSpriteSheet(const SpriteSheet& sprites)
+    {
+        for(std::uint32_t emitterIndex = 0; emitterIndex < _emitterIndexWatermark; emitterIndex++)
+        {
+            const EmitterBehaviour& behaviour = _emitterParameters[emitterIndex].Behaviour;
+
+            if((behaviour.NumberOfSprites > 0) &&
+               ((behaviour.FirstSprite + behaviour.NumberOfSprites) > sprites.GetNumberOfSprites()))
+            {
+                std::cerr << "Particle system error: Emitter " << emitterIndex << " uses " << behaviour.NumberOfSprites << " sprites starting at " << behaviour.FirstSprite
+                    << ", but the new sprite sheet only has " << sprites.GetNumberOfSprites() << "\n";
+                __debugbreak();
+            };
+        };
+
+        // The scene uniforms pick up the new number of sprites on their next write
+        _particleSprites = sprites;
+    };
+
+
+    /// <summary>
+    /// Change an emitter's parameters. Nothing is uploaded until the next FlushPendingParticles(), 
+    /// so changing the parameters of many emitters in a frame still costs a single copy
+    /// </summary>
+    /// <param name="emitterIndex"></param>
+    /// <param name="emitterParameters"></param>
+    void SetEmitterParameters(const std::uint32_t emitterIndex, const EmitterParameters& emitterParameters)
+    {
+        const EmitterBehaviour& behaviour = emitterParameters.Behaviour;
+
+        if((behaviour.NumberOfSprites > 0) &&
+           ((behaviour.FirstSprite + behaviour.NumberOfSprites) > _particleSprites.get().GetNumberOfSprites()))
+        {
+            std::cerr << "Particle system error: Emitter " << emitterIndex << " uses " << behaviour.NumberOfSprites << " sprites starting at " << behaviour.FirstSprite
+                << ", but there are only " << _particleSprites.get().GetNumberOfSprites() << "\n";
+            __debugbreak();
+        };
+
+        EmitterParameters& currentEmitterParameters = _emitterParameters[emitterIndex];
+
+        if(std::memcmp(&currentEmitterParameters, &emitterParameters, sizeof(EmitterParameters)) == 0)
+            return;
+
+        currentEmitterParameters = emitterParameters;
+
+        if(_firstDirtyEmitter == _endDirtyEmitter)
+        {
+            _firstDirtyEmitter = emitterIndex;
+            _endDirtyEmitter = emitterIndex + 1;
+        }
+        else
+        {
+            _firstDirtyEmitter = std::min(_firstDirtyEmitter, emitterIndex);
+            _endDirtyEmitter = std::max(_endDirtyEmitter, emitterIndex + 1);
+        };
+    };
+
+    const EmitterParameters& GetEmitterParameters(const std::uint32_t emitterIndex) const
+    {
+        return _emitterParameters[emitterIndex];
+    };
+
+
+    /// <summary>
+    /// Bind all the state needed to update and draw particles
+    /// </summary>
+    void Bind() const
+    {
+        _particleVAO.get().Bind();
+
+
+        _computeShaderProgram.get().Bind();
+
+        // Bind SSBOs to their respective binding points
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, GetInputParticleBuffer().GetBufferID());
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, GetOutputParticleBuffer().GetBufferID());
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, _outputParticleInstancesBuffer.GetBufferID());
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, _emitterParametersBuffer.GetBufferID());
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, _aliveCountsBuffer.GetBufferID());
+
+
+        _particleShaderProgram.get().Bind();
+
+        // A single binding, however many sprites there are
+        _particleSprites.get().Bind(SpritesTextureUnit);
+    };
+
+
+    /// <summary>
+    /// Update the particles of every emitter with a single dispatch
+    /// </summary>
+    /// <param name="deltaTime"></param>
+    void Update(const float deltaTime)
+    {
+        CompactIfRequested();
+
+        UpdateRange(deltaTime, 0, GetNumberOfParticles());
+
+        SwapParticleBuffers();
+    };
+
+    /// <summary>
+    /// Draw the particles of every emitter with a single draw call. 
+    /// Like every draw, must come after SwapParticleBuffers(), which places the barrier the frame's updates share
+    /// </summary>
+    void Draw() const
+    {
+        DrawRange(0, GetNumberOfParticles());
+    };
+
+    /// <summary>
+    /// Draw the particles of every emitter with a single indirect multi-draw, one command per emitter.
+    /// Unlike Draw(), particles of freed emitters are skipped entirely
+    /// </summary>
+    void DrawIndirect() const
+    {
+        _particleShaderProgram.get().Bind();
+
+        _drawCommandsBuffer.Bind();
+
+        // Every command's first vertex is the emitter's first particle's first vertex
+        glMultiDrawArraysIndirect(GL_TRIANGLES, nullptr, _emitterIndexWatermark, 0);
+    };
+
+
+    /// <summary>
+    /// Update a single emitter's particles. The first emitter updated in a frame may compact the particles first, so its range is looked up afterwards
+    /// </summary>
+    /// <param name="deltaTime"></param>
+    /// <param name="emitterIndex"></param>
+    void UpdateEmitter(const float deltaTime, const std::uint32_t emitterIndex)
+    {
+        CompactIfRequested();
+
+        const ParticleArena::Block& particleRange = _emitterParticleRanges[emitterIndex];
+
+        UpdateRange(deltaTime, particleRange.FirstParticle, particleRange.NumberOfParticles);
+    };
+
+    /// <summary>
+    /// Update a range of particles. Never compacts the particles, so the range stays valid. 
+    /// Once every range was updated for this frame, SwapParticleBuffers() must be called before any of them are drawn
+    /// </summary>
+    /// <param name="deltaTime"></param>
+    /// <param name="firstParticle"></param>
+    /// <param name="numberOfParticles"></param>
+    void UpdateRange(const float deltaTime, const std::uint32_t firstParticle, const std::uint32_t numberOfParticles)
+    {
+        // Once per frame, unless ranges are updated with different time steps
+        WriteSceneUniforms(deltaTime);
+
+        if(numberOfParticles == 0)
+            return;
+
+        // Particles of emitters that were created since the last update
+        FlushPendingParticles();
+
+        _computeShaderProgram.get().SetUniform(_computeUniforms.FirstParticle, firstParticle);
+        _computeShaderProgram.get().SetUniform(_computeUniforms.NumberOfParticles, numberOfParticles);
+
+        // The shader skips the particles of the last work group that are past the range
+        _updateDispatches.Dispatch(_computeShaderProgram.get(), (numberOfParticles + _particlesPerWorkGroup - 1) / _particlesPerWorkGroup);
+
+        _currentFrameSavedCopyBytes += sizeof(ComputeShaderParticle) * numberOfParticles;
+
+        // Some of this frame's particles were updated in place, they can't be moved until the next frame
+        _compactionRequested = false;
+    };
+
+
+    /// <summary>
+    /// Compact the particles, if SwapParticleBuffers() found the arena too fragmented and nothing was updated since. 
+    /// Called by Update() and UpdateEmitter(), before the frame's first update, so the instances drawn at the old positions were already consumed. 
+    /// Emitters' ranges may move, they must be looked up after this call
+    /// </summary>
+    void CompactIfRequested()
+    {
+        if(_compactionRequested == false)
+            return;
+
+        _compactionRequested = false;
+
+        CompactParticles();
+    };
+
+
+    /// <summary>
+    /// Make this frame's output particle buffer the next frame's input, 
+    /// with a single barrier after every update of the frame
+    /// </summary>
+    void SwapParticleBuffers()
+    {
+        _updateDispatches.Submit(UpdateBarrierBits);
+
+        ReadBackAliveCounts();
+
+        // The next frame writes its own, the binding stays valid for this frame's draws
+        _sceneUniformsWritten = false;
+
+        _inputParticleBufferIndex = 1 - _inputParticleBufferIndex;
+
+        _frame++;
+
+        // Every command that reads this frame's streamed data was issued
+        _streamingBuffer.NextFrame();
+
+        // Moving particles now would leave this frame's instances at the old positions, so they're moved before the next frame's first update
+        if(_particleArena.IsFragmented(MaxArenaFragmentation) == true)
+            _compactionRequested = true;
+
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, GetInputParticleBuffer().GetBufferID());
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, GetOutputParticleBuffer().GetBufferID());
+
+
+        _lastFrameSavedCopyBytes = _currentFrameSavedCopyBytes;
+        _currentFrameSavedCopyBytes = 0;
+
+        _lastFrameEmitterUploadBytes = _currentFrameEmitterUploadBytes;
+        _currentFrameEmitterUploadBytes = 0;
+    };
+
+    /// <summary>
+    /// Draw a range of particles
+    /// </summary>
+    /// <param name="firstParticle"></param>
+    /// <param name="numberOfParticles"></param>
+    void DrawRange(const std::uint32_t firstParticle, const std::uint32_t numberOfParticles) const
+    {
+        _particleShaderProgram.get().Bind();
+
+        // The vertex shader finds a vertex's particle from gl_VertexID
+        glDrawArrays(GL_TRIANGLES, VerticesPerParticle * firstParticle, VerticesPerParticle * numberOfParticles);
+    };
+
+
+private:
+
+    /// <summary>
+    /// Make sure the compute shader's 'Particle' struct was laid out exactly like ComputeShaderParticle
+    /// </summary>
+    /// <param name="computeShaderProgram"></param>
+    static void CheckParticleLayout(const ComputeShaderProgram& computeShaderProgram)
+    {
+        struct ParticleMember
+        {
+            const char* Name = nullptr;
+            std::size_t Offset = 0;
+        };
+
+        constexpr ParticleMember particleMembers[] =
+        {
+            { "InParticles[0].TrajectoryX", offsetof(ComputeShaderParticle, TrajectoryX) },
+            { "InParticles[0].Opacity", offsetof(ComputeShaderParticle, Opacity) },
+            { "InParticles[0].PackedTrajectory", offsetof(ComputeShaderParticle, PackedTrajectory) },
+            { "InParticles[0].PackedRates", offsetof(ComputeShaderParticle, PackedRates) },
+            { "InParticles[0].EmitterIndex", offsetof(ComputeShaderParticle, EmitterIndex) },
+        };
+
+        const std::uint32_t programID = computeShaderProgram.GetProgramID();
+
+        for(const ParticleMember& particleMember : particleMembers)
+        {
+            const std::uint32_t resourceIndex = glGetProgramResourceIndex(programID, GL_BUFFER_VARIABLE, particleMember.Name);
+
+            // Members the compiler optimized away have no layout to check
+            if(resourceIndex == GL_INVALID_INDEX)
+                continue;
+
+            constexpr GLenum properties[] = { GL_OFFSET, GL_TOP_LEVEL_ARRAY_STRIDE };
+            GLint values[2] = { };
+
+            glGetProgramResourceiv(programID, GL_BUFFER_VARIABLE, resourceIndex, 2, properties, 2, nullptr, values);
+
+            if((static_cast<std::size_t>(values[0]) != particleMember.Offset) ||
+               (static_cast<std::size_t>(values[1]) != sizeof(ComputeShaderParticle)))
+            {
+                std::cerr << "Particle layout error: \"" << particleMember.Name << "\" has an offset of " << values[0] << " and a stride of " << values[1]
+                    << ", expected " << particleMember.Offset << " and " << sizeof(ComputeShaderParticle) << "\n";
+                __debugbreak();
+            };
+        };
+    };
+
+
+    /// <summary>
+    /// Write the current frame's scene uniforms to the streaming buffer, and bind them for every program. 
+    /// Nothing is written if they didn't change since the last write of this frame
+    /// </summary>
+    /// <param name="deltaTime"></param>
+    void WriteSceneUniforms(const float deltaTime)
+    {
+        const SceneUniforms sceneUniforms =
+        {
+            .CartesianToScaledNDC = glm::vec2(2.0f / (WindowWidth * _particleScaleFactor), 2.0f / (WindowHeight * _particleScaleFactor)),
+            .DeltaTime = deltaTime,
+            .Frame = _frame,
+            .NumberOfSprites = _particleSprites.get().GetNumberOfSprites(),
+        };
+
+        if((_sceneUniformsWritten == true) &&
+           (std::memcmp(&sceneUniforms, &_sceneUniforms, sizeof(SceneUniforms)) == 0))
+            return;
+
+        _sceneUniforms = sceneUniforms;
+        _sceneUniformsWritten = true;
+
+        // The streaming buffer's regions already rotate per frame in flight, so the GPU never reads a block that is being overwritten
+        const std::size_t streamingOffset = _streamingBuffer.Write(&_sceneUniforms, sizeof(SceneUniforms), _uniformBufferOffsetAlignment);
+
+        glBindBufferRange(GL_UNIFORM_BUFFER, SceneUniformsBinding, _streamingBuffer.GetBufferID(), streamingOffset, sizeof(SceneUniforms));
+    };
+
+
+    std::size_t GetAliveCountsSizeInBytes() const
+    {
+        return sizeof(std::uint32_t) * (_maxNumberOfEmitters + 1);
+    };
+
+    void ClearAliveCounts()
+    {
+        const std::uint32_t zero = 0;
+
+        _aliveCountsBuffer.Bind();
+        glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+    };
+
+
+    /// <summary>
+    /// Copy this frame's alive counts to the readback buffer, and check on the counts of previous frames. Never waits for the GPU
+    /// </summary>
+    void ReadBackAliveCounts()
+    {
+        PollAliveCountReadbacks();
+
+        if(_numberOfDrainingEmitters == 0)
+            return;
+
+
+        AliveCountReadback& aliveCountReadback = _aliveCountReadbacks[_nextAliveCountReadback];
+
+        // If the readback is still in flight this frame's counts are skipped, rather than waited for
+        if(aliveCountReadback.Readback.IsPending() == false)
+        {
+            _aliveCountsBuffer.GetBufferAsync<std::uint32_t>(aliveCountReadback.Readback, _maxNumberOfEmitters + 1);
+
+            aliveCountReadback.Frame = _frame;
+            aliveCountReadback.Consumed = false;
+
+            _nextAliveCountReadback = (_nextAliveCountReadback + 1) % _framesInFlight;
+        };
+
+        // The next frame counts from zero
+        ClearAliveCounts();
+    };
+
+
+    /// <summary>
+    /// Mark every draining emitter with no live particles in a finished readback as drained
+    /// </summary>
+    void PollAliveCountReadbacks()
+    {
+        for(AliveCountReadback& aliveCountReadback : _aliveCountReadbacks)
+        {
+            if((aliveCountReadback.Consumed == true) ||
+               (aliveCountReadback.Readback.IsReady() == false))
+                continue;
+
+            aliveCountReadback.Consumed = true;
+
+
+            const std::uint32_t* aliveCounts = aliveCountReadback.Readback.GetData<std::uint32_t>();
+
+            for(std::uint32_t emitterIndex = 0; emitterIndex < _emitterIndexWatermark; emitterIndex++)
+            {
+                // Counts taken before the emitter started draining, or before its index was reused, don't say anything about it
+                if((_drainStartFrames[emitterIndex] <= aliveCountReadback.Frame) &&
+                   (aliveCounts[emitterIndex] == 0))
+                {
+                    _drainedEmitters[emitterIndex] = 1;
+                };
+            };
+        };
+    };
+
+
+    /// <summary>
+    /// Take over a recycled range of exactly numberOfParticles particles
+    /// </summary>
+    /// <param name="numberOfParticles"></param>
+    /// <param name="particleRange"></param>
+    /// <returns> False if there is no recycled range of that size </returns>
+    bool TakeRecycledParticleRange(const std::uint32_t numberOfParticles, ParticleArena::Block& particleRange)
+    {
+        const auto bucket = _recycledParticleRanges.find(numberOfParticles);
+
+        if((bucket == _recycledParticleRanges.end()) ||
+           (bucket->second.empty() == true))
+            return false;
+
+        particleRange = bucket->second.back();
+        bucket->second.pop_back();
+
+        _recycledParticles -= numberOfParticles;
+
+        return true;
+    };
+
+    /// <summary>
+    /// Give every recycled range back to the arena
+    /// </summary>
+    void ReleaseRecycledParticleRanges()
+    {
+        for(auto& [numberOfParticles, recycledRanges] : _recycledParticleRanges)
+        {
+            for(const ParticleArena::Block& particleRange : recycledRanges)
+                _particleArena.Free(particleRange);
+
+            recycledRanges.clear();
+        };
+
+        _recycledParticles = 0;
+    };
+
+
+    /// <summary>
+    /// Point an emitter's draw command at its range of particles
+    /// </summary>
+    /// <param name="emitterIndex"></param>
+    void SetDrawCommand(const std::uint32_t emitterIndex)
+    {
+        const ParticleArena::Block& particleRange = _emitterParticleRanges[emitterIndex];
+
+        const DrawArraysIndirectCommand drawCommand =
+        {
+            .Count = VerticesPerParticle * particleRange.NumberOfParticles,
+            .InstanceCount = 1,
+            .First = VerticesPerParticle * particleRange.FirstParticle,
+            .BaseInstance = 0,
+        };
+
+        WriteDrawCommand(emitterIndex, drawCommand);
+    };
+
+    /// <summary>
+    /// Overwrite a draw command through the streaming buffer, 
+    /// so the write lands in this frame's region instead of waiting on draws of frames that are still in flight
+    /// </summary>
+    /// <param name="emitterIndex"></param>
+    /// <param name="drawCommand"></param>
+    void WriteDrawCommand(const std::uint32_t emitterIndex, const DrawArraysIndirectCommand& drawCommand)
+    {
+        const std::size_t streamingOffset = _streamingBuffer.Write(&drawCommand, sizeof(DrawArraysIndirectCommand));
+
+        _streamingBuffer.CopyTo(streamingOffset, _drawCommandsBuffer.GetBufferID(), sizeof(DrawArraysIndirectCommand) * emitterIndex, sizeof(DrawArraysIndirectCommand));
+    };
+
+
+    /// <summary>
+    /// Make a range of particles, in both particle buffers, belong to the extra always-inactive emitter. 
+    /// The compute shader then keeps them hidden without knowing about the arena's holes
+    /// </summary>
+    /// <param name="firstParticle"></param>
+    /// <param name="numberOfParticles"></param>
+    void ClearParticles(const std::uint32_t firstParticle, const std::uint32_t numberOfParticles)
+    {
+        if(numberOfParticles == 0)
+            return;
+
+        // Every member is 4 bytes, so the whole particle can be filled with the emitter index. 
+        // The other members end up as garbage, which is fine for particles that are never reset or drawn
+        const std::uint32_t inactiveEmitterIndex = _maxNumberOfEmitters;
+
+        for(const ShaderStorageBuffer& particleBuffer : _particleBuffers)
+        {
+            particleBuffer.Bind();
+
+            glClearBufferSubData(GL_SHADER_STORAGE_BUFFER, GL_R32UI,
+                                 sizeof(ComputeShaderParticle) * firstParticle, sizeof(ComputeShaderParticle) * numberOfParticles,
+                                 GL_RED_INTEGER, GL_UNSIGNED_INT, &inactiveEmitterIndex);
+        };
+    };
+
+
+    /// <summary>
+    /// Remove an emitter's pending seed request, if it has one. 
+    /// Requests seed separate ranges, so their order doesn't matter, and the last request takes the removed one's place
+    /// </summary>
+    /// <param name="emitterIndex"></param>
+    void DropSeedRequest(const std::uint32_t emitterIndex)
+    {
+        const std::uint32_t requestIndex = _pendingSeedRequestIndices[emitterIndex];
+
+        if(requestIndex == NoSeedRequest)
+            return;
+
+        const EmitterSeedRequest& lastRequest = _pendingSeedRequests.back();
+
+        _pendingSeedRequestIndices[lastRequest.EmitterIndex] = requestIndex;
+        _pendingSeedRequests[requestIndex] = lastRequest;
+
+        _pendingSeedRequests.pop_back();
+
+        _pendingSeedRequestIndices[emitterIndex] = NoSeedRequest;
+    };
+
+
+    /// <summary>
+    /// If a range of particles overlaps a block of the arena
+    /// </summary>
+    /// <param name="block"></param>
+    /// <param name="firstParticle"></param>
+    /// <param name="numberOfParticles"></param>
+    /// <returns></returns>
+    static bool Overlaps(const ParticleArena::Block& block, const std::uint32_t firstParticle, const std::uint32_t numberOfParticles)
+    {
+        return (firstParticle < (block.FirstParticle + block.NumberOfParticles)) &&
+               (block.FirstParticle < (firstParticle + numberOfParticles));
+    };
+
+
+    /// <summary>
+    /// Remove the holes between emitter ranges, so fewer particles are updated and drawn.
+    /// Particles are copied from the input to the output particle buffer at their new position, and then the buffers swap roles. 
+    /// Must only be called between updates, when the input buffer holds every particle's latest state
+    /// </summary>
+    void CompactParticles()
+    {
+        // Recycled ranges would otherwise be packed together with the emitters' ranges
+        ReleaseRecycledParticleRanges();
+
+        if(_particleArena.GetStatistics().NumberOfHoles == 0)
+            return;
+
+        // Queued seeds and uploads target the old ranges
+        FlushPendingParticles();
+
+        const std::uint32_t oldHighWaterMark = _particleArena.GetHighWaterMark();
+
+        const std::vector<ParticleArena::Move> moves = _particleArena.Compact();
+
+
+        const ShaderStorageBuffer& inputParticleBuffer = GetInputParticleBuffer();
+        const ShaderStorageBuffer& outputParticleBuffer = GetOutputParticleBuffer();
+
+        glBindBuffer(GL_COPY_READ_BUFFER, inputParticleBuffer.GetBufferID());
+        glBindBuffer(GL_COPY_WRITE_BUFFER, outputParticleBuffer.GetBufferID());
+
+        // Everything before the first hole stays where it is
+        const std::uint32_t firstMovedParticle = moves.empty() ? oldHighWaterMark : moves.front().DestinationFirstParticle;
+
+        if(firstMovedParticle > 0)
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, sizeof(ComputeShaderParticle) * firstMovedParticle);
+
+        for(const ParticleArena::Move& move : moves)
+        {
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+                                sizeof(ComputeShaderParticle) * move.SourceFirstParticle,
+                                sizeof(ComputeShaderParticle) * move.DestinationFirstParticle,
+                                sizeof(ComputeShaderParticle) * move.NumberOfParticles);
+        };
+
+
+        _inputParticleBufferIndex = 1 - _inputParticleBufferIndex;
+
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, GetInputParticleBuffer().GetBufferID());
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, GetOutputParticleBuffer().GetBufferID());
+
+        ClearParticles(_particleArena.GetHighWaterMark(), oldHighWaterMark - _particleArena.GetHighWaterMark());
+
+
+        // Moves are sorted, so every emitter's range is found with a binary search
+        for(std::uint32_t emitterIndex = 0; emitterIndex < _emitterIndexWatermark; emitterIndex++)
+        {
+            ParticleArena::Block& particleRange = _emitterParticleRanges[emitterIndex];
+
+            if(particleRange.NumberOfParticles == 0)
+                continue;
+
+            const auto move = std::upper_bound(moves.cbegin(), moves.cend(), particleRange.FirstParticle, [](const std::uint32_t firstParticle, const ParticleArena::Move& move)
+            {
+                return firstParticle < move.SourceFirstParticle;
+            });
+
+            // Ranges before the first hole don't move
+            if(move == moves.cbegin())
+                continue;
+
+            const ParticleArena::Move& containingMove = *(move - 1);
+
+            particleRange.FirstParticle = particleRange.FirstParticle - containingMove.SourceFirstParticle + containingMove.DestinationFirstParticle;
+
+            SetDrawCommand(emitterIndex);
+        };
+    };
+
+
+    /// <summary>
+    /// Upload the span of emitter parameters that changed since the last upload, with a single write to the streaming buffer and a single copy. 
+    /// Unchanged emitters inside the span are uploaded too, which is cheaper than a copy per changed emitter
+    /// </summary>
+    void FlushEmitterParameters()
+    {
+        if(_firstDirtyEmitter == _endDirtyEmitter)
+            return;
+
+        const std::size_t sizeInBytes = sizeof(EmitterParameters) * (_endDirtyEmitter - _firstDirtyEmitter);
+
+        const std::size_t streamingOffset = _streamingBuffer.Write(_emitterParameters.data() + _firstDirtyEmitter, sizeInBytes);
+
+        _streamingBuffer.CopyTo(streamingOffset, _emitterParametersBuffer.GetBufferID(), sizeof(EmitterParameters) * _firstDirtyEmitter, sizeInBytes);
+
+        _currentFrameEmitterUploadBytes += sizeInBytes;
+
+        _firstDirtyEmitter = 0;
+        _endDirtyEmitter = 0;
+    };
+
+
+    /// <summary>
+    /// Initialize the particles of every new emitter with a single dispatch, one row of work groups per emitter
+    /// </summary>
+    void FlushSeedRequests()
+    {
+        if(_pendingSeedRequests.empty() == true)
+            return;
+
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, GetInputParticleBuffer().GetBufferID());
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, _emitterParametersBuffer.GetBufferID());
+
+        _seedShaderProgram.get().SetUniform(_seedFrameUniform, _frame);
+
+
+        // An emitter has at most one request, so requests are written in batches of at most one per emitter
+        for(std::size_t batchStart = 0; batchStart < _pendingSeedRequests.size(); batchStart += _maxNumberOfEmitters)
+        {
+            const std::uint32_t batchSize = static_cast<std::uint32_t>(std::min<std::size_t>(_pendingSeedRequests.size() - batchStart, _maxNumberOfEmitters));
+
+            const std::size_t batchSizeInBytes = sizeof(EmitterSeedRequest) * batchSize;
+
+            const std::size_t streamingOffset = _streamingBuffer.Write(_pendingSeedRequests.data() + batchStart, batchSizeInBytes, _storageBufferOffsetAlignment);
+
+            // The shader reads the requests straight from the streaming buffer
+            glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 4, _streamingBuffer.GetBufferID(), streamingOffset, batchSizeInBytes);
+
+
+            // The dispatch is wide enough for the largest request
+            std::uint32_t maxParticlesPerRequest = 0;
+
+            for(std::size_t i = batchStart; i < (batchStart + batchSize); i++)
+                maxParticlesPerRequest = std::max(maxParticlesPerRequest, _pendingSeedRequests[i].NumberOfParticles);
+
+            _seedDispatches.Dispatch(_seedShaderProgram.get(), (maxParticlesPerRequest + 63) / 64, batchSize);
+        };
+
+        // Batches write separate ranges, so only their consumers have to wait
+        _seedDispatches.Submit(SeedBarrierBits);
+
+
+        for(const EmitterSeedRequest& seedRequest : _pendingSeedRequests)
+            _pendingSeedRequestIndices[seedRequest.EmitterIndex] = NoSeedRequest;
+
+        _pendingSeedRequests.clear();
+    };
+
+
+    /// <summary>
+    /// Upload every queued range of particles. 
+    /// As many queued ranges as fit in a region of the streaming buffer are written with a single call, and then copied to their destination on the GPU
+    /// </summary>
+    void FlushParticleUploads()
+    {
+        if(_pendingParticleUploads.empty() == true)
+            return;
+
+        const std::uint32_t destinationBufferID = GetInputParticleBuffer().GetBufferID();
+
+        const std::size_t maxParticlesPerWrite = _streamingBuffer.GetRegionSizeInBytes() / sizeof(ComputeShaderParticle);
+
+
+        std::size_t uploadIndex = 0;
+        std::size_t particleOffset = 0;
+
+        while(uploadIndex < _pendingParticleUploads.size())
+        {
+            // Find how many uploads fit in a region. There is always at least one, even if it's too large, so Write() can report it
+            std::size_t batchEnd = uploadIndex + 1;
+            std::size_t batchParticles = _pendingParticleUploads[uploadIndex].NumberOfParticles;
+
+            while((batchEnd < _pendingParticleUploads.size()) &&
+                  ((batchParticles + _pendingParticleUploads[batchEnd].NumberOfParticles) <= maxParticlesPerWrite))
+            {
+                batchParticles += _pendingParticleUploads[batchEnd].NumberOfParticles;
+                batchEnd++;
+            };
+
+
+            const std::size_t streamingOffset = _streamingBuffer.Write(_pendingParticles.data() + particleOffset, sizeof(ComputeShaderParticle) * batchParticles);
+
+            std::size_t batchOffset = 0;
+
+            for(std::size_t i = uploadIndex; i < batchEnd; i++)
+            {
+                const PendingParticleUpload& upload = _pendingParticleUploads[i];
+
+                _streamingBuffer.CopyTo(streamingOffset + (sizeof(ComputeShaderParticle) * batchOffset),
+                                        destinationBufferID,
+                                        sizeof(ComputeShaderParticle) * upload.FirstParticle,
+                                        sizeof(ComputeShaderParticle) * upload.NumberOfParticles);
+
+                batchOffset += upload.NumberOfParticles;
+            };
+
+
+            particleOffset += batchParticles;
+            uploadIndex = batchEnd;
+        };
+
+
+        _pendingParticles.clear();
+        _pendingParticleUploads.clear();
+    };
+
+
+public:
+
+    std::uint32_t GetMaxNumberOfEmitters() const
+    {
+        return _maxNumberOfEmitters;
+    };
+
+    std::uint32_t GetMaxNumberOfParticles() const
+    {
+        return _maxNumberOfEmitters * _particlesPerEmitter;
+    };
+
+    /// <summary>
+    /// The number of particles that are updated and drawn, including the holes freed emitters left behind
+    /// </summary>
+    /// <returns></returns>
+    std::uint32_t GetNumberOfParticles() const
+    {
+        return _particleArena.GetHighWaterMark();
+    };
+
+    /// <summary>
+    /// The first particle of an emitter's range. Can change whenever the particle buffers are compacted
+    /// </summary>
+    /// <param name="emitterIndex"></param>
+    /// <returns></returns>
+    std::uint32_t GetEmitterFirstParticle(const std::uint32_t emitterIndex) const
+    {
+        return _emitterParticleRanges[emitterIndex].FirstParticle;
+    };
+
+    /// <summary>
+    /// The number of particles owned by live emitters
+    /// </summary>
+    /// <returns></returns>
+    std::uint32_t GetNumberOfLiveParticles() const
+    {
+        return _particleArena.GetStatistics().AllocatedParticles - _recycledParticles;
+    };
+
+    /// <summary>
+    /// The number of particles in ranges of destroyed emitters that are kept for new emitters of the same size
+    /// </summary>
+    /// <returns></returns>
+    std::uint32_t GetNumberOfRecycledParticles() const
+    {
+        return _recycledParticles;
+    };
+
+    /// <summary>
+    /// How the particle buffers are used by emitter ranges. Recycled ranges count as allocated
+    /// </summary>
+    /// <returns></returns>
+    ParticleArena::Statistics GetArenaStatistics() const
+    {
+        return _particleArena.GetStatistics();
+    };
+
+    /// <summary>
+    /// The number of particles an emitter gets if it doesn't ask for a specific number
+    /// </summary>
+    /// <returns></returns>
+    std::uint32_t GetParticlesPerEmitter() const
+    {
+        return _particlesPerEmitter;
+    };
+
+    float GetParticleScaleFactor() const
+    {
+        return _particleScaleFactor;
+    };
+
+    /// <summary>
+    /// How many frames the CPU may submit before the GPU finishes them, as given by the FramePacer
+    /// </summary>
+    /// <returns></returns>
+    std::uint32_t GetFramesInFlight() const
+    {
+        return _framesInFlight;
+    };
+
+    /// <summary>
+    /// How many update dispatches shared the last frame's barrier
+    /// </summary>
+    /// <returns></returns>
+    std::uint32_t GetUpdateDispatchesPerBarrier() const
+    {
+        return _updateDispatches.GetNumberOfSubmittedDispatches();
+    };
+
+    /// <summary>
+    /// The number of bytes of emitter parameters that were uploaded during the last frame
+    /// </summary>
+    /// <returns></returns>
+    std::size_t GetEmitterUploadBytesPerFrame() const
+    {
+        return _lastFrameEmitterUploadBytes;
+    };
+
+    /// <summary>
+    /// How many times per-frame CPU writes had to wait for the GPU to finish with a region of the streaming buffer
+    /// </summary>
+    /// <returns></returns>
+    std::uint64_t GetStreamingStalls() const
+    {
+        return _streamingBuffer.GetNumberOfStalls();
+    };
+
+    /// <summary>
+    /// The frame the next update (And seeding) will use to key random streams
+    /// </summary>
+    /// <returns></returns>
+    std::uint32_t GetFrame() const
+    {
+        return _frame;
+    };
+
+    /// <summary>
+    /// The number of bytes ping-ponging the particle buffers saved from being copied during the last frame
+    /// </summary>
+    /// <returns></returns>
+    std::size_t GetSavedCopyBytesPerFrame() const
+    {
+        return _lastFrameSavedCopyBytes;
+    };
+
+
+    /// <summary>
+    /// The particle buffer the next update will read from
+    /// </summary>
+    /// <returns></returns>
+    const ShaderStorageBuffer& GetInputParticleBuffer() const
+    {
+        return _particleBuffers[_inputParticleBufferIndex];
+    };
+
+    /// <summary>
+    /// The particle buffer the next update will write to
+    /// </summary>
+    /// <returns></returns>
+    const ShaderStorageBuffer& GetOutputParticleBuffer() const
+    {
+        return _particleBuffers[1 - _inputParticleBufferIndex];
+    };
+
+    const ShaderStorageBuffer& GetOutputParticleInstancesBuffer() const
+    {
+        return _outputParticleInstancesBuffer;
+    };
+
+
+public:
+
+    ParticleSystem& operator = (const ParticleSystem&) = delete;
+
+};
\ No newline at end of file
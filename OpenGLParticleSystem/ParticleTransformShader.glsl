@@ -1,24 +1,21 @@
 
 #version 430
 
-layout(local_size_x = 64) in;
+// Both can be injected by ComputeShaderProgram, the auto-tuner compiles a variant for every combination it tries
+#ifndef WORK_GROUP_SIZE
+#define WORK_GROUP_SIZE 64
+#endif
 
+// Every invocation updates this many particles, WORK_GROUP_SIZE particles apart, so a work group still reads contiguous particles
+#ifndef PARTICLES_PER_INVOCATION
+#define PARTICLES_PER_INVOCATION 1
+#endif
 
-struct Particle
-{
-    float TrajectoryA;
-    float TrajectoryB;
-
-    vec2 Trajectory;
+layout(local_size_x = WORK_GROUP_SIZE) in;
 
-    mat4 Transform;
-    
-    float Rate;
 
-    float Opacity;
-
-    float OpacityDecreaseRate;
-};
+#include "ParticleShaderCommon.glsl"
+#include "SceneUniforms.glsl"
 
 
 layout(std430, binding = 0) readonly buffer InParticlesBuffer
@@ -31,44 +28,35 @@ layout(std430, binding = 1) writeonly buffer OutTransformsBuffer
     Particle OutParticles[];
 };
 
-layout(std430, binding = 2) writeonly buffer OutParticleScreenTransformsBuffer
+// Everything needed to draw a particle: (NDC position, Scale, Opacity)
+layout(std430, binding = 2) writeonly buffer OutParticleInstancesBuffer
 {
-    mat4 OutParticleScreenTransforms[];
+    vec4 OutParticleInstances[];
 };
 
-layout(std430, binding = 3) writeonly buffer OutParticleOpacityBuffer
+layout(std430, binding = 3) readonly buffer EmittersBuffer
 {
-    float OutParticleOpacities[];
+    Emitter Emitters[];
 };
 
+// The number of live particles of every draining emitter, indexed by emitter. Cleared every frame
+layout(std430, binding = 5) buffer AliveCountsBuffer
+{
+    uint AliveCounts[];
+};
 
 
-uniform mat4 ParticleTransform;
-uniform mat4 ParticleEmmiterTransform;
-
-uniform uint WindowWidth;
-uniform uint WindowHeight;
-
-uniform float ParticleScaleFactor;
 
-uniform float DeltaTime;
+// The range of particles this dispatch will update, the only uniforms that change between dispatches
+uniform uint FirstParticle;
+uniform uint NumberOfParticles;
 
 
 
+// Already divided by the particle scale factor, with a reciprocal precomputed on the CPU instead of a division per particle
 vec2 CartesianToNDC(vec2 cartesianPosition)
 {
-    return vec2(((2.0f * cartesianPosition.x) / WindowWidth), 
-                ((2.0f * cartesianPosition.y) / WindowHeight));
-};
-
-
-mat4 Translate(mat4 inputMatrix, vec3 translationVector)
-{
-    mat4 result = mat4(inputMatrix);
-
-	result[3] = inputMatrix[0] * translationVector[0] + inputMatrix[1] * translationVector[1] + inputMatrix[2] * translationVector[2] + inputMatrix[3];
-
-	return result;
+    return cartesianPosition * CartesianToScaledNDC;
 };
 
 
@@ -78,105 +66,82 @@ float ParticleTrajectoryFunction(float particleX, float a = 1.0f, float b = 1.0f
 };
 
 
-float RandomNumberGenerator(vec2 uv, float seed)
-{
-    float fixedSeed = abs(seed) + 1.0;
-
-    float x = dot(uv, vec2(12.9898, 78.233) * fixedSeed);
 
-    return fract(sin(x) * 43758.5453);
-};
-
-
-float RandomNumberGenerator(vec2 uv, float seed, float min, float max)
+void UpdateParticle(const uint particleIndex)
 {
-    const float rng = RandomNumberGenerator(uv, seed);
-    
-    // Map [0, 1] to [min, max] 
-    const float rngResult = min + rng * (max - min);
-
-    return rngResult;
-};
+    Particle particle = InParticles[particleIndex];
 
+    const Emitter emitter = Emitters[particle.EmitterIndex];
 
-void InitializeParticleValues(out Particle particle)
-{
-    const vec2 uv = vec2(DeltaTime, 1.0f / DeltaTime);
+    // Once a draining emitter's particle faded out it never resets
+    const bool dead = (emitter.Draining != 0) && (particle.Opacity <= 0.0f);
 
-    const float rngSeed = DeltaTime;
-                          
+    // Particles of a removed emitter, and dead particles, are kept as they are, but hidden
+    if((emitter.Active == 0) || 
+       (dead == true))
+    {
+        OutParticleInstances[particleIndex] = vec4(0.0f);
+        OutParticles[particleIndex] = particle;
+        return;
+    };
 
-    const float newTrajectoryA = RandomNumberGenerator(uv, rngSeed, 0.01f, 0.1f);
 
-    // A very simple way of creating some trajectory variation
-    const float newTrajectoryB = (mod(gl_GlobalInvocationID.x, 2)) == 0 ?
-        -RandomNumberGenerator(uv, rngSeed, 4.0f, 4.5f) :
-        RandomNumberGenerator(uv, rngSeed, 4.0f, 4.5f);
+    const vec2 trajectory = unpackHalf2x16(particle.PackedTrajectory);
+    const vec2 rates = unpackHalf2x16(particle.PackedRates);
 
+    // Calculate next trajectory position
+    particle.TrajectoryX += rates.x * DeltaTime;
+    const float trajectoryY = ParticleTrajectoryFunction(particle.TrajectoryX, trajectory.x, trajectory.y);
 
-    // Correct the rate depending on trajectory direction
-    const float newRate = sign(newTrajectoryB) == -1.0f ?
-        // "Left" trajectory 
-        -RandomNumberGenerator(uv, rngSeed, 11.5f, 20.0f) :
-        // "Right" trajectory
-        RandomNumberGenerator(uv, rngSeed, 11.5f, 20.0f);
+    // Update opacity
+    particle.Opacity -= rates.y * DeltaTime;
 
 
-    const float newOpacityDecreaseRate = RandomNumberGenerator(uv, rngSeed, 0.05f, 0.1f);
+    const vec2 ndcPosition = CartesianToNDC(vec2(particle.TrajectoryX, trajectoryY));
+    
+    const vec2 screenPosition = emitter.Origin + (emitter.AxisX * ndcPosition.x) + (emitter.AxisY * ndcPosition.y);
 
 
+    // If we write the particle's instance after we reset, it can sometime cause flickering.
+    OutParticleInstances[particleIndex] = vec4(screenPosition, emitter.Scale, particle.Opacity);
 
-    particle.TrajectoryA = newTrajectoryA;
-    particle.TrajectoryB = newTrajectoryB;
 
-    particle.Trajectory = vec2(0.0f);
-    particle.Rate = newRate;
+    // If the particle is outside screen bounds..
+    if ((screenPosition.y < -1.0f) || 
+         (particle.Opacity <= 0.0f))
+    {
+        // A draining emitter's particle dies instead
+        if(emitter.Draining != 0)
+            particle.Opacity = 0.0f;
+        else
+            // "Reset" the particle
+            InitializeParticleValues(particle, particleIndex, emitter, Frame);
+    };
 
-    particle.Opacity = 1.0f;
-    particle.OpacityDecreaseRate = newOpacityDecreaseRate;
+    if((emitter.Draining != 0) && 
+       (particle.Opacity > 0.0f))
+    {
+        atomicAdd(AliveCounts[particle.EmitterIndex], 1u);
+    };
 
 
-    // Apply custom particle transform
-    particle.Transform = ParticleTransform;
+    OutParticles[particleIndex] = particle;
 };
 
 
-
 void main()
 {
-    // TODO: Try to write the output particles directly into the input SSBO instead of copying on CPU
-
-    Particle particle = InParticles[gl_GlobalInvocationID.x];
-
-    // Calculate next trajectory position
-    particle.Trajectory.x += particle.Rate * DeltaTime;
-    particle.Trajectory.y = ParticleTrajectoryFunction(particle.Trajectory.x, particle.TrajectoryA, particle.TrajectoryB);
-
-    // Update opacity
-    particle.Opacity -= particle.OpacityDecreaseRate * DeltaTime;
+    // Every work group updates a contiguous block of WORK_GROUP_SIZE * PARTICLES_PER_INVOCATION particles
+    const uint blockStart = gl_WorkGroupID.x * (WORK_GROUP_SIZE * PARTICLES_PER_INVOCATION);
 
-
-    const vec2 ndcPosition = CartesianToNDC(particle.Trajectory) / ParticleScaleFactor;
-    
-    mat4 screenTransfrom = (Translate(ParticleEmmiterTransform, vec3(ndcPosition.x, ndcPosition.y, 0.0f))) * particle.Transform;
-
-    const vec3 screenPosition = vec3(screenTransfrom[3]);
-
-
-    
-    // If we write the particle's opacity value after we reset, it can sometime cause flickering.
-    OutParticleOpacities[gl_GlobalInvocationID.x] = particle.Opacity;
-
-
-    // If the particle is outside screen bounds..
-    if ((screenPosition.y < -1.0f) || 
-         (particle.Opacity <= 0.0f))
+    for(uint i = 0; i < PARTICLES_PER_INVOCATION; i++)
     {
-        // "Reset" the particle
-        InitializeParticleValues(particle);
-    };
+        const uint rangeIndex = blockStart + (i * WORK_GROUP_SIZE) + gl_LocalInvocationID.x;
 
+        // The dispatch is rounded up to a whole block, the last block's tail is past the range
+        if(rangeIndex >= NumberOfParticles)
+            return;
 
-    OutParticles[gl_GlobalInvocationID.x] = particle;
-    OutParticleScreenTransforms[gl_GlobalInvocationID.x] = screenTransfrom;
+        UpdateParticle(FirstParticle + rangeIndex);
+    };
 };
\ No newline at end of file
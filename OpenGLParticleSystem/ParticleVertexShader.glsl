@@ -1,32 +1,77 @@
 #version 430 core
 
-layout(location = 0) in vec2 Position;
-layout(location = 1) in vec2 TextureCoordinate;
-layout(location = 2) in float Opacity;
+// Particles are drawn without vertex attributes. 
+// Every particle is 6 vertices, so the particle and the quad's corner are both derived from gl_VertexID
 
-layout(location = 3) in uint TextureUnit;
 
-layout(location = 4) in mat4 Transform;
+#include "ParticleShaderCommon.glsl"
+#include "SceneUniforms.glsl"
 
 
+// The latest particles, the input of the next update. Only read for finding a particle's emitter
+layout(std430, binding = 0) readonly buffer ParticlesBuffer
+{
+    Particle Particles[];
+};
+
+// (NDC position, Scale, Opacity), written by ParticleTransformShader.glsl
+layout(std430, binding = 2) readonly buffer ParticleInstancesBuffer
+{
+    vec4 ParticleInstances[];
+};
+
+layout(std430, binding = 3) readonly buffer EmittersBuffer
+{
+    Emitter Emitters[];
+};
+
+// (UV offset, UV scale) of the sprite in every layer of the sprite array, see SpriteSheet
+layout(std430, binding = 6) readonly buffer SpriteUVRectsBuffer
+{
+    vec4 SpriteUVRects[];
+};
+
 
+// Bottom left, Bottom right, Top right, Top right, Top left, Bottom left
+const vec2 QuadCorners[6] = vec2[6](vec2(-1.0f, -1.0f), 
+                                    vec2( 1.0f, -1.0f), 
+                                    vec2( 1.0f,  1.0f),
+                                    vec2( 1.0f,  1.0f), 
+                                    vec2(-1.0f,  1.0f), 
+                                    vec2(-1.0f, -1.0f));
 
 
-out vec2 VertexShaderTextureCoordinateOutput;
+// (U, V, Sprite array layer)
+out vec3 VertexShaderTextureCoordinateOutput;
 out float VertexShaderOpacityOutput;
-flat out uint VertexShaderTextureUnitOutput;
 
 
 
 void main()
 {
-    VertexShaderTextureCoordinateOutput = TextureCoordinate;
-    
-    VertexShaderOpacityOutput = Opacity;
+    const uint particleIndex = uint(gl_VertexID) / 6u;
+
+    const vec2 corner = QuadCorners[uint(gl_VertexID) % 6u];
+
+    const vec4 instance = ParticleInstances[particleIndex];
+
+
+    VertexShaderOpacityOutput = instance.w;
     
-    VertexShaderTextureUnitOutput = TextureUnit;
+    // Particles cycle through their emitter's set of sprites
+    const EmitterBehaviour behaviour = Emitters[Particles[particleIndex].EmitterIndex].Behaviour;
+
+    const uint sprite = (behaviour.NumberOfSprites == 0u) ? 
+        (particleIndex % NumberOfSprites) :
+        (behaviour.FirstSprite + (particleIndex % behaviour.NumberOfSprites));
+
+    // The sprite only covers part of its layer
+    const vec4 uvRect = SpriteUVRects[sprite];
+
+    VertexShaderTextureCoordinateOutput = vec3(uvRect.xy + (((corner * 0.5f) + 0.5f) * uvRect.zw), float(sprite));
 
 
 
-    gl_Position = Transform * vec4(Position, 0.0f, 1.0f);
+    // Place the quad's corner around the particle's position
+    gl_Position = vec4(instance.xy + (corner * instance.z), 0.0f, 1.0f);
 };
\ No newline at end of file
@@ -0,0 +1,18 @@
+// Per-frame data shared by every particle program, written once per frame by ParticleSystem. 
+// Included by both compute and render shaders, after their '#version' directive
+
+
+// Must match SceneUniforms in Particle.hpp
+layout(std140, binding = 0) uniform SceneBuffer
+{
+    // (2 / (WindowWidth * ParticleScaleFactor), 2 / (WindowHeight * ParticleScaleFactor))
+    vec2 CartesianToScaledNDC;
+
+    float DeltaTime;
+
+    // Keys the random streams of particles that reset this frame
+    uint Frame;
+
+    // Particles cycle through the sprites by their index, unless their emitter picks a set of sprites
+    uint NumberOfSprites;
+};
\ No newline at end of file
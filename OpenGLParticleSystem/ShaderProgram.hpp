@@ -8,7 +8,10 @@
 #include <glm/gtc/type_ptr.hpp>
 #include <iostream>
 #include <fstream>
-#include <unordered_map>
+#include <string_view>
+
+#include "GLUtilities.hpp"
+#include "ShaderUniforms.hpp"
 
 
 /// <summary>
@@ -19,9 +22,9 @@ class ShaderProgram
 private:
 
     /// <summary>
-    /// A list of known, cached, Uniform locations
+    /// Every active uniform, found when the program was linked
     /// </summary>
-    mutable std::unordered_map<std::string, std::uint32_t> _uniformLocations;
+    mutable ShaderUniformTable _uniforms;
 
     /// <summary>
     /// An identifier used by the API
@@ -44,6 +47,8 @@ public:
 
         glDeleteShader(fragmentShaderID);
         glDeleteShader(vertexShaderID);
+
+        _uniforms.Reflect(_programID);
     };
 
     ~ShaderProgram()
@@ -58,36 +63,62 @@ public:
     };
 
 
-    void SetVector3(const std::string& name, const float value1, const float value2, const float value3) const
+    /// <summary>
+    /// Find a uniform once, so it can be set every frame without looking its name up
+    /// </summary>
+    /// <typeparam name="T"></typeparam>
+    /// <param name="name"></param>
+    /// <returns></returns>
+    template<typename T>
+    UniformHandle<T> GetUniformHandle(const std::string_view& name) const
+    {
+        return _uniforms.GetHandle<T>(name);
+    };
+
+    /// <summary>
+    /// Set a uniform. Nothing is sent if it already has this value, and the program doesn't have to be bound
+    /// </summary>
+    /// <typeparam name="T"></typeparam>
+    /// <param name="handle"></param>
+    /// <param name="value"></param>
+    template<typename T>
+    void SetUniform(const UniformHandle<T> handle, const T& value) const
     {
-        const std::uint32_t colourUniformLocation = GetUniformLocation(name);
+        _uniforms.Set(handle, value);
+    };
+
+    template<typename T>
+    void SetUniformArray(const UniformHandle<T> handle, const T* values, const std::size_t count) const
+    {
+        _uniforms.SetArray(handle, values, count);
+    };
+
+
+    // Setters by name look the uniform up every call, prefer handles for anything set every frame
 
-        glUniform3f(colourUniformLocation, value1, value2, value3);
+    void SetVector3(const std::string& name, const float value1, const float value2, const float value3) const
+    {
+        SetVector3(name, glm::vec3(value1, value2, value3));
     };
 
     void SetVector3(const std::string& name, const glm::vec3& vector) const
     {
-        SetVector3(name, vector.x, vector.y, vector.z);
+        SetUniform(GetUniformHandle<glm::vec3>(name), vector);
     };
 
     void SetFloat(const std::string& name, const float& value) const
     {
-        const std::uint32_t uniformLocation = GetUniformLocation(name);
-        glUniform1f(uniformLocation, value);
+        SetUniform(GetUniformHandle<float>(name), value);
     };
 
     void SetMatrix4(const std::string& name, const glm::mat4& matrix) const
     {
-        const std::uint32_t uniformLocation = GetUniformLocation(name);
-
-        glUniformMatrix4fv(uniformLocation, 1, false, glm::value_ptr(matrix));
+        SetUniform(GetUniformHandle<glm::mat4>(name), matrix);
     };
 
     void SetInt(const std::string& name, const int value) const
     {
-        const std::uint32_t uniformLocation = GetUniformLocation(name);
-
-        glUniform1i(uniformLocation, value);
+        SetUniform(GetUniformHandle<int>(name), value);
     };
 
     void SetBool(const std::string& name, const bool value) const
@@ -113,7 +144,7 @@ private:
     /// <returns></returns>
     std::uint32_t CompileVertexShader(const std::string& filename) const
     {
-        const std::string vertexShaderSource = ReadAllText(filename);
+        const std::string vertexShaderSource = GL::ReadShaderSource(filename);
 
         std::uint32_t vertexShaderID = 0;
         vertexShaderID = glCreateShader(GL_VERTEX_SHADER);
@@ -156,7 +187,7 @@ private:
     /// <returns></returns>
     std::uint32_t CompileFragmentShader(const std::string& filename) const
     {
-        const std::string fragmentShaderSource = ReadAllText(filename);
+        const std::string fragmentShaderSource = GL::ReadShaderSource(filename);
 
         std::uint32_t fragmentShaderID = 0;
         fragmentShaderID = glCreateShader(GL_FRAGMENT_SHADER);
@@ -228,67 +259,4 @@ private:
         return programID;
     };
 
-
-    /// <summary>
-    /// Find the location of a uniform
-    /// </summary>
-    /// <param name="name"></param>
-    /// <returns></returns>
-    std::uint32_t GetUniformLocation(const std::string& name) const
-    {
-        // Check if uniform exists in cache
-        const auto result = _uniformLocations.find(name);
-
-        int uniformLocation = -1;
-
-        // If name uniform isn't cached...
-        if(result == _uniformLocations.cend())
-        {
-            // Find the uniform
-            uniformLocation = glGetUniformLocation(_programID, name.c_str());
-
-            if(uniformLocation == -1)
-            {
-                std::cerr << "Uniform location error: Unable to find \"" << name << "\"\n";
-                __debugbreak();
-            }
-            else
-            {
-                // Add to cache
-                _uniformLocations.insert(std::make_pair(name, static_cast<std::uint32_t>(uniformLocation)));
-            };
-        }
-        // If uniform was found...
-        else
-        {
-            uniformLocation = result->second;
-        };
-
-        return uniformLocation;
-    };
-
-
-    /// <summary>
-    /// Read all text inside a file
-    /// </summary>
-    /// <param name="filename"> Path to sid file </param>
-    /// <returns></returns>
-    std::string ReadAllText(const std::string& filename) const
-    {
-        // Open the file at the end so we can easily find its length
-        std::ifstream fileStream = std::ifstream(filename, std::ios::ate);
-
-        std::string fileContents;
-
-        // Resize the buffer to fit content
-        fileContents.resize(fileStream.tellg());
-
-        fileStream.seekg(std::ios::beg);
-
-        // Read file contents into the buffer
-        fileStream.read(fileContents.data(), fileContents.size());
-
-        return fileContents;
-    };
-
 };
\ No newline at end of file
@@ -6,6 +6,7 @@
 #include <functional>
 
 #include "VertexBuffer.hpp"
+#include "AsyncBufferReadback.hpp"
 
 
 /// <summary>
@@ -68,7 +69,8 @@ public:
     };
 
     /// <summary>
-    /// Retrieve the data inside the SSBO to bufferData
+    /// Retrieve the data inside the SSBO to bufferData. 
+    /// Stalls until the GPU is done with every command that writes to the buffer, see GetBufferAsync() for reads that don't
     /// </summary>
     /// <typeparam name="T"> The type of data contained in the buffer </typeparam>
     /// <param name="bufferData"> A pointer to buffer data which will be filled </param>
@@ -82,6 +84,20 @@ public:
         glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, sizeof(T) * elemetOffset, sizeof(T) * numberOfElementsInBuffer, bufferData);
     };
 
+    /// <summary>
+    /// Start reading the data inside the SSBO without stalling. 
+    /// The data can be read with readback.GetData&lt;T&gt;() once readback.IsReady() returns true
+    /// </summary>
+    /// <typeparam name="T"> The type of data contained in the buffer </typeparam>
+    /// <param name="readback"> A readback with no request in flight </param>
+    /// <param name="numberOfElements"> The number of _elements_ to read </param>
+    /// <param name="elementOffset"> The _element_ offset at which to start reading from </param>
+    template<typename T>
+    void GetBufferAsync(AsyncBufferReadback& readback, const std::size_t numberOfElements, const std::size_t elementOffset = 0) const
+    {
+        readback.Request(_bufferId, sizeof(T) * elementOffset, sizeof(T) * numberOfElements);
+    };
+
 
     void Destroy() const
     {
@@ -0,0 +1,245 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <type_traits>
+#include <iostream>
+#include <glad/glad.h>
+#include <glm/vec3.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+
+/// <summary>
+/// A typed reference to one of a program's uniforms, found once by name and then used without any lookup
+/// </summary>
+/// <typeparam name="T"> float, int, std::uint32_t, glm::vec3, or glm::mat4. Samplers are set as int </typeparam>
+template<typename T>
+struct UniformHandle
+{
+    static constexpr std::uint32_t InvalidIndex = static_cast<std::uint32_t>(-1);
+
+    /// <summary>
+    /// The uniform's index inside its program's ShaderUniformTable
+    /// </summary>
+    std::uint32_t Index = InvalidIndex;
+
+
+    bool IsValid() const
+    {
+        return Index != InvalidIndex;
+    };
+};
+
+
+/// <summary>
+/// Every active uniform of a linked program, found by reflection.
+/// The last value sent to every uniform is shadowed, so setting a uniform to the value it already has doesn't reach the driver
+/// </summary>
+class ShaderUniformTable
+{
+
+private:
+
+    /// <summary>
+    /// An active uniform, as reported by glGetProgramResourceiv
+    /// </summary>
+    struct Uniform
+    {
+        /// <summary>
+        /// The uniform's name. Arrays are named after their first element, "Textures[0]"
+        /// </summary>
+        std::string Name;
+
+        GLint Location = -1;
+
+        GLenum Type = GL_NONE;
+
+        /// <summary>
+        /// The number of elements, 1 if the uniform isn't an array
+        /// </summary>
+        GLint ArraySize = 1;
+
+        /// <summary>
+        /// The bytes of the last value that was sent. Empty until a value is sent
+        /// </summary>
+        std::vector<std::byte> Shadow;
+    };
+
+
+    std::uint32_t _programID = 0;
+
+    std::vector<Uniform> _uniforms;
+
+
+public:
+
+    /// <summary>
+    /// Find every active uniform of a linked program. Uniforms inside uniform blocks have no location, and are skipped
+    /// </summary>
+    /// <param name="programID"></param>
+    void Reflect(const std::uint32_t programID)
+    {
+        _programID = programID;
+
+        _uniforms.clear();
+
+
+        GLint numberOfUniforms = 0;
+        glGetProgramInterfaceiv(programID, GL_UNIFORM, GL_ACTIVE_RESOURCES, &numberOfUniforms);
+
+        _uniforms.reserve(numberOfUniforms);
+
+        for(GLint uniformIndex = 0; uniformIndex < numberOfUniforms; uniformIndex++)
+        {
+            constexpr GLenum properties[] = { GL_NAME_LENGTH, GL_LOCATION, GL_TYPE, GL_ARRAY_SIZE };
+            GLint values[4] = { };
+
+            glGetProgramResourceiv(programID, GL_UNIFORM, uniformIndex, 4, properties, 4, nullptr, values);
+
+            if(values[1] == -1)
+                continue;
+
+            Uniform uniform;
+
+            uniform.Location = values[1];
+            uniform.Type = static_cast<GLenum>(values[2]);
+            uniform.ArraySize = values[3];
+
+            // The reported length includes the null terminator
+            uniform.Name.resize(values[0]);
+            glGetProgramResourceName(programID, GL_UNIFORM, uniformIndex, values[0], nullptr, uniform.Name.data());
+            uniform.Name.pop_back();
+
+            _uniforms.push_back(std::move(uniform));
+        };
+    };
+
+
+    /// <summary>
+    /// Find a uniform by name. Meant to be called once, when the program is set up, and not every frame
+    /// </summary>
+    /// <typeparam name="T"></typeparam>
+    /// <param name="name"> The uniform's name. An array can be named with or without its "[0]" </param>
+    /// <returns></returns>
+    template<typename T>
+    UniformHandle<T> GetHandle(const std::string_view& name) const
+    {
+        for(std::size_t uniformIndex = 0; uniformIndex < _uniforms.size(); uniformIndex++)
+        {
+            const Uniform& uniform = _uniforms[uniformIndex];
+
+            const bool nameMatches = (uniform.Name == name) ||
+                                     ((uniform.ArraySize > 1) && (uniform.Name.size() == (name.size() + 3)) &&
+                                      (uniform.Name.compare(0, name.size(), name) == 0) && (uniform.Name.compare(name.size(), 3, "[0]") == 0));
+
+            if(nameMatches == false)
+                continue;
+
+            if(IsCompatibleType<T>(uniform.Type) == false)
+            {
+                std::cerr << "Uniform error: \"" << name << "\" is of GL type 0x" << std::hex << uniform.Type << std::dec << ", which can't be set from the requested type\n";
+                __debugbreak();
+            };
+
+            return { .Index = static_cast<std::uint32_t>(uniformIndex) };
+        };
+
+        std::cerr << "Uniform location error: Unable to find \"" << name << "\"\n";
+        __debugbreak();
+
+        return { };
+    };
+
+
+    /// <summary>
+    /// Set a uniform, unless it already has this value
+    /// </summary>
+    /// <typeparam name="T"></typeparam>
+    /// <param name="handle"></param>
+    /// <param name="value"></param>
+    template<typename T>
+    void Set(const UniformHandle<T> handle, const T& value)
+    {
+        SetArray(handle, &value, 1);
+    };
+
+    /// <summary>
+    /// Set the first elements of an array uniform, unless they already have these values
+    /// </summary>
+    /// <typeparam name="T"></typeparam>
+    /// <param name="handle"></param>
+    /// <param name="values"></param>
+    /// <param name="count"> Must not be larger than the array </param>
+    template<typename T>
+    void SetArray(const UniformHandle<T> handle, const T* values, const std::size_t count)
+    {
+        if(handle.IsValid() == false)
+            return;
+
+        Uniform& uniform = _uniforms[handle.Index];
+
+        const std::size_t sizeInBytes = sizeof(T) * count;
+
+        if((uniform.Shadow.size() == sizeInBytes) &&
+           (std::memcmp(uniform.Shadow.data(), values, sizeInBytes) == 0))
+            return;
+
+        // Only allocates the first time a uniform is set
+        uniform.Shadow.resize(sizeInBytes);
+        std::memcpy(uniform.Shadow.data(), values, sizeInBytes);
+
+        const GLsizei elementCount = static_cast<GLsizei>(count);
+
+        // Sent straight to the program, so it doesn't have to be bound
+        if constexpr(std::is_same_v<T, float>)
+            glProgramUniform1fv(_programID, uniform.Location, elementCount, values);
+        else if constexpr(std::is_same_v<T, int>)
+            glProgramUniform1iv(_programID, uniform.Location, elementCount, values);
+        else if constexpr(std::is_same_v<T, std::uint32_t>)
+            glProgramUniform1uiv(_programID, uniform.Location, elementCount, values);
+        else if constexpr(std::is_same_v<T, glm::vec3>)
+            glProgramUniform3fv(_programID, uniform.Location, elementCount, glm::value_ptr(*values));
+        else if constexpr(std::is_same_v<T, glm::mat4>)
+            glProgramUniformMatrix4fv(_programID, uniform.Location, elementCount, false, glm::value_ptr(*values));
+        else
+            static_assert(sizeof(T) == 0, "Unsupported type");
+    };
+
+
+private:
+
+    template<typename T>
+    static bool IsCompatibleType(const GLenum type)
+    {
+        if constexpr(std::is_same_v<T, float>)
+            return type == GL_FLOAT;
+        else if constexpr(std::is_same_v<T, int>)
+        {
+            switch(type)
+            {
+                case GL_INT:
+                case GL_BOOL:
+                case GL_SAMPLER_2D:
+                case GL_SAMPLER_2D_ARRAY:
+                    return true;
+
+                default:
+                    return false;
+            };
+        }
+        else if constexpr(std::is_same_v<T, std::uint32_t>)
+            return type == GL_UNSIGNED_INT;
+        else if constexpr(std::is_same_v<T, glm::vec3>)
+            return type == GL_FLOAT_VEC3;
+        else if constexpr(std::is_same_v<T, glm::mat4>)
+            return type == GL_FLOAT_MAT4;
+        else
+            return false;
+    };
+
+};
\ No newline at end of file
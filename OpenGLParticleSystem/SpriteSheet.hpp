@@ -0,0 +1,288 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <glad/glad.h>
+#include <glm/vec2.hpp>
+#include <glm/vec4.hpp>
+
+#include "GLUtilities.hpp"
+#include "TextureArray.hpp"
+#include "ShaderStorageBuffer.hpp"
+
+
+/// <summary>
+/// Decoded RGBA8 pixels of a single sprite
+/// </summary>
+struct SpriteImage
+{
+    std::uint32_t Width = 0;
+    std::uint32_t Height = 0;
+
+    /// <summary>
+    /// Tightly packed rows, bottom row first
+    /// </summary>
+    std::vector<std::uint8_t> Pixels;
+};
+
+
+/// <summary>
+/// Every particle sprite in a single texture array, one sprite per layer, so all of them are bound with a single binding.
+/// Layers are as large as the largest sprite, every sprite sits in its layer's bottom-left corner, and its UV rect tells how much of the layer it covers
+/// </summary>
+class SpriteSheet
+{
+
+public:
+
+    /// <summary>
+    /// The SSBO binding the particle vertex shader reads the UV rects from
+    /// </summary>
+    static constexpr std::uint32_t UVRectsBinding = 6;
+
+
+private:
+
+    TextureArray _textureArray;
+
+    /// <summary>
+    /// (UV offset, UV scale) of every sprite inside its layer
+    /// </summary>
+    std::vector<glm::vec4> _uvRects;
+
+    /// <summary>
+    /// An SSBO of the UV rects, indexed by layer
+    /// </summary>
+    ShaderStorageBuffer _uvRectsBuffer;
+
+
+public:
+
+    SpriteSheet(TextureArray&& textureArray, std::vector<glm::vec4>&& uvRects) :
+        _textureArray(std::move(textureArray)),
+        _uvRects(std::move(uvRects)),
+        _uvRectsBuffer(_uvRects.data(), sizeof(glm::vec4) * _uvRects.size(), UVRectsBinding)
+    {
+    };
+
+    SpriteSheet(SpriteSheet&&) noexcept = default;
+
+    SpriteSheet(const SpriteSheet&) = delete;
+
+
+public:
+
+    /// <summary>
+    /// A sprite sheet with a transparent layer for every sprite, and their UV rects, for sprites that are uploaded later
+    /// </summary>
+    /// <param name="spriteSizes"> The width and height of every sprite, in layer order </param>
+    /// <returns></returns>
+    static SpriteSheet Allocate(const std::vector<glm::uvec2>& spriteSizes)
+    {
+        std::uint32_t layerWidth = 0;
+        std::uint32_t layerHeight = 0;
+
+        for(const glm::uvec2& spriteSize : spriteSizes)
+        {
+            layerWidth = std::max(layerWidth, spriteSize.x);
+            layerHeight = std::max(layerHeight, spriteSize.y);
+        };
+
+
+        TextureArray textureArray = TextureArray(layerWidth, layerHeight, static_cast<std::uint32_t>(spriteSizes.size()));
+
+        std::vector<glm::vec4> uvRects;
+        uvRects.reserve(spriteSizes.size());
+
+        for(const glm::uvec2& spriteSize : spriteSizes)
+            uvRects.push_back({ 0.0f, 0.0f, static_cast<float>(spriteSize.x) / layerWidth, static_cast<float>(spriteSize.y) / layerHeight });
+
+
+        return SpriteSheet(std::move(textureArray), std::move(uvRects));
+    };
+
+    /// <summary>
+    /// Pack sprites into the layers of a new texture array, in the given order
+    /// </summary>
+    /// <param name="sprites"></param>
+    /// <returns></returns>
+    static SpriteSheet Pack(const std::vector<SpriteImage>& sprites)
+    {
+        std::vector<glm::uvec2> spriteSizes;
+        spriteSizes.reserve(sprites.size());
+
+        for(const SpriteImage& sprite : sprites)
+            spriteSizes.push_back({ sprite.Width, sprite.Height });
+
+
+        SpriteSheet spriteSheet = Allocate(spriteSizes);
+
+        for(std::uint32_t layer = 0; layer < sprites.size(); layer++)
+        {
+            const SpriteImage& sprite = sprites[layer];
+
+            spriteSheet._textureArray.SetLayer(layer, 0, 0, sprite.Width, sprite.Height, sprite.Pixels.data());
+        };
+
+        spriteSheet._textureArray.GenerateMipmaps();
+
+
+        return spriteSheet;
+    };
+
+
+    /// <summary>
+    /// Load every image file and pack them, in the given order
+    /// </summary>
+    /// <param name="spritePaths"></param>
+    /// <returns></returns>
+    static SpriteSheet PackFiles(const std::vector<std::string>& spritePaths)
+    {
+        std::vector<SpriteImage> sprites;
+        sprites.reserve(spritePaths.size());
+
+        for(const std::string& spritePath : spritePaths)
+            sprites.push_back(LoadSpriteImage(spritePath));
+
+        return Pack(sprites);
+    };
+
+
+    /// <summary>
+    /// Decode an image file into RGBA8, whatever its number of channels
+    /// </summary>
+    /// <param name="spritePath"></param>
+    /// <returns></returns>
+    static SpriteImage LoadSpriteImage(const std::string& spritePath)
+    {
+        int width = 0;
+        int height = 0;
+        int channels = 0;
+
+        // Same orientation as GL::GenerateTexture, so UVs don't change. 
+        // Set for the calling thread only, sprites may be decoded on several threads at once
+        stbi_set_flip_vertically_on_load_thread(true);
+        std::uint8_t* pixels = stbi_load(spritePath.c_str(), &width, &height, &channels, 4);
+
+        if(pixels == nullptr)
+        {
+            std::cerr << "Sprite load error: \"" << spritePath << "\", \"" << stbi_failure_reason() << "\"\n";
+            __debugbreak();
+
+            return { };
+        };
+
+        SpriteImage sprite =
+        {
+            .Width = static_cast<std::uint32_t>(width),
+            .Height = static_cast<std::uint32_t>(height),
+            .Pixels = std::vector<std::uint8_t>(pixels, pixels + (static_cast<std::size_t>(width) * height * 4)),
+        };
+
+        stbi_image_free(pixels);
+
+        return sprite;
+    };
+
+    /// <summary>
+    /// Read only an image file's header, for its size, without decoding it
+    /// </summary>
+    /// <param name="spritePath"></param>
+    /// <returns></returns>
+    static glm::uvec2 ReadSpriteSize(const std::string& spritePath)
+    {
+        int width = 0;
+        int height = 0;
+        int channels = 0;
+
+        if(stbi_info(spritePath.c_str(), &width, &height, &channels) == 0)
+        {
+            std::cerr << "Sprite load error: \"" << spritePath << "\", \"" << stbi_failure_reason() << "\"\n";
+            __debugbreak();
+
+            return { };
+        };
+
+        return { static_cast<std::uint32_t>(width), static_cast<std::uint32_t>(height) };
+    };
+
+    /// <summary>
+    /// The paths of every PNG in a directory, ordered by file name so layers don't depend on the file system's order. 
+    /// A directory without any is an error
+    /// </summary>
+    /// <param name="directory"></param>
+    /// <returns></returns>
+    static std::vector<std::string> FindSprites(const std::string_view& directory)
+    {
+        std::vector<std::string> spritePaths;
+
+        std::error_code error;
+
+        for(const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(directory, error))
+        {
+            if((entry.is_regular_file() == true) &&
+               (entry.path().extension() == ".png"))
+                spritePaths.push_back(entry.path().string());
+        };
+
+        std::sort(spritePaths.begin(), spritePaths.end());
+
+        if(spritePaths.empty() == true)
+        {
+            std::cerr << "Sprite sheet error: No sprites were found in \"" << directory << "\"\n";
+            __debugbreak();
+        };
+
+        return spritePaths;
+    };
+
+
+    /// <summary>
+    /// Bind the texture array to a texture unit, and the UV rects to UVRectsBinding
+    /// </summary>
+    /// <param name="textureUnit"></param>
+    void Bind(const std::uint32_t textureUnit = 0) const
+    {
+        _textureArray.Bind(textureUnit);
+
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, UVRectsBinding, _uvRectsBuffer.GetBufferID());
+    };
+
+
+public:
+
+    std::uint32_t GetNumberOfSprites() const
+    {
+        return static_cast<std::uint32_t>(_uvRects.size());
+    };
+
+    const std::vector<glm::vec4>& GetUVRects() const
+    {
+        return _uvRects;
+    };
+
+    const TextureArray& GetTextureArray() const
+    {
+        return _textureArray;
+    };
+
+    /// <summary>
+    /// For writing layers of a sprite sheet that was allocated empty
+    /// </summary>
+    /// <returns></returns>
+    TextureArray& GetTextureArray()
+    {
+        return _textureArray;
+    };
+
+
+public:
+
+    SpriteSheet& operator = (const SpriteSheet&) = delete;
+
+};
\ No newline at end of file
@@ -0,0 +1,269 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+#include <iostream>
+#include <glad/glad.h>
+
+
+/// <summary>
+/// A persistently mapped GPU buffer that per-frame CPU data is written straight into.
+/// The buffer is split into regions, one per frame in flight. Every frame allocates from its own region,
+/// and a region is only reused once the fence placed after its last frame was signaled, so writes never wait on a map or unmap
+/// </summary>
+class StreamingBuffer
+{
+
+public:
+
+    /// <summary>
+    /// A piece of the current region
+    /// </summary>
+    struct Allocation
+    {
+        /// <summary>
+        /// Where the CPU should write the data
+        /// </summary>
+        void* Data = nullptr;
+
+        /// <summary>
+        /// The offset of the data inside the buffer, for copies and glBindBufferRange
+        /// </summary>
+        std::size_t Offset = 0;
+    };
+
+
+private:
+
+    /// <summary>
+    /// An identifier used by the API
+    /// </summary>
+    std::uint32_t _bufferId = 0;
+
+    /// <summary>
+    /// The size of a single region in bytes
+    /// </summary>
+    std::size_t _regionSizeInBytes = 0;
+
+    /// <summary>
+    /// The persistent mapping of the whole buffer
+    /// </summary>
+    std::byte* _mappedBuffer = nullptr;
+
+    /// <summary>
+    /// A fence for every region, placed when the region was retired. Null if the GPU was never given the region's data
+    /// </summary>
+    std::vector<GLsync> _regionFences;
+
+    /// <summary>
+    /// The region allocations are made from
+    /// </summary>
+    std::size_t _currentRegion = 0;
+
+    /// <summary>
+    /// The offset, inside the current region, of the next allocation
+    /// </summary>
+    std::size_t _regionHead = 0;
+
+
+    /// <summary>
+    /// How many times a region had to be waited on, because the GPU was still reading it
+    /// </summary>
+    std::uint64_t _numberOfStalls = 0;
+
+
+public:
+
+    StreamingBuffer(const std::size_t regionSizeInBytes, const std::uint32_t numberOfRegions = 3) :
+        _regionSizeInBytes(regionSizeInBytes),
+        _regionFences(numberOfRegions, nullptr)
+    {
+        if(GLAD_GL_VERSION_4_4 == 0)
+        {
+            std::cerr << "Streaming buffer error: glBufferStorage requires OpenGL 4.4\n";
+            __debugbreak();
+        };
+
+        constexpr GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+        const std::size_t bufferSizeInBytes = regionSizeInBytes * numberOfRegions;
+
+        glGenBuffers(1, &_bufferId);
+
+        glBindBuffer(GL_COPY_READ_BUFFER, _bufferId);
+
+        // Immutable storage is what allows the buffer to stay mapped while the GPU uses it
+        glBufferStorage(GL_COPY_READ_BUFFER, bufferSizeInBytes, nullptr, flags);
+
+        _mappedBuffer = static_cast<std::byte*>(glMapBufferRange(GL_COPY_READ_BUFFER, 0, bufferSizeInBytes, flags));
+    };
+
+
+    StreamingBuffer(StreamingBuffer&& other) noexcept :
+        _bufferId(other._bufferId),
+        _regionSizeInBytes(other._regionSizeInBytes),
+        _mappedBuffer(other._mappedBuffer),
+        _regionFences(std::move(other._regionFences)),
+        _currentRegion(other._currentRegion),
+        _regionHead(other._regionHead),
+        _numberOfStalls(other._numberOfStalls)
+    {
+        other._bufferId = 0;
+        other._mappedBuffer = nullptr;
+    };
+
+    StreamingBuffer(const StreamingBuffer&) = delete;
+
+
+    ~StreamingBuffer()
+    {
+        for(GLsync fence : _regionFences)
+        {
+            if(fence != nullptr)
+                glDeleteSync(fence);
+        };
+
+        if(_bufferId != 0)
+        {
+            glBindBuffer(GL_COPY_READ_BUFFER, _bufferId);
+            glUnmapBuffer(GL_COPY_READ_BUFFER);
+
+            glDeleteBuffers(1, &_bufferId);
+        };
+    };
+
+
+public:
+
+    /// <summary>
+    /// Allocate room in the current region.
+    /// If the region is full it's retired early, the same way NextFrame() retires it
+    /// </summary>
+    /// <param name="sizeInBytes"> Must not be larger than a region </param>
+    /// <param name="alignment"> The alignment of the allocation's offset, for example GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT </param>
+    /// <returns></returns>
+    Allocation Allocate(const std::size_t sizeInBytes, const std::size_t alignment = 4)
+    {
+        if(sizeInBytes > _regionSizeInBytes)
+        {
+            std::cerr << "Streaming buffer error: An allocation of " << sizeInBytes << " bytes is larger than a region (" << _regionSizeInBytes << " bytes)\n";
+            __debugbreak();
+        };
+
+        std::size_t offset = ((_regionHead + alignment - 1) / alignment) * alignment;
+
+        if((offset + sizeInBytes) > _regionSizeInBytes)
+        {
+            NextFrame();
+
+            offset = 0;
+        };
+
+        _regionHead = offset + sizeInBytes;
+
+        const std::size_t bufferOffset = (_currentRegion * _regionSizeInBytes) + offset;
+
+        return
+        {
+            .Data = _mappedBuffer + bufferOffset,
+            .Offset = bufferOffset,
+        };
+    };
+
+
+    /// <summary>
+    /// Allocate room for, and write, data in the current region
+    /// </summary>
+    /// <param name="data"></param>
+    /// <param name="sizeInBytes"></param>
+    /// <param name="alignment"></param>
+    /// <returns> The offset of the data inside the buffer </returns>
+    std::size_t Write(const void* data, const std::size_t sizeInBytes, const std::size_t alignment = 4)
+    {
+        const Allocation allocation = Allocate(sizeInBytes, alignment);
+
+        std::memcpy(allocation.Data, data, sizeInBytes);
+
+        return allocation.Offset;
+    };
+
+
+    /// <summary>
+    /// Copy previously written data into another buffer, entirely on the GPU
+    /// </summary>
+    /// <param name="sourceOffset"> An offset returned by Allocate() or Write() </param>
+    /// <param name="destinationBufferID"></param>
+    /// <param name="destinationOffset"></param>
+    /// <param name="sizeInBytes"></param>
+    void CopyTo(const std::size_t sourceOffset, const std::uint32_t destinationBufferID, const std::size_t destinationOffset, const std::size_t sizeInBytes) const
+    {
+        glBindBuffer(GL_COPY_READ_BUFFER, _bufferId);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, destinationBufferID);
+
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, sourceOffset, destinationOffset, sizeInBytes);
+    };
+
+
+    /// <summary>
+    /// Retire the current region once every command that reads it was issued, and move on to the next region.
+    /// Waits only if the GPU hasn't finished with the next region yet
+    /// </summary>
+    void NextFrame()
+    {
+        _regionFences[_currentRegion] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+        _currentRegion = (_currentRegion + 1) % _regionFences.size();
+        _regionHead = 0;
+
+
+        GLsync& fence = _regionFences[_currentRegion];
+
+        if(fence == nullptr)
+            return;
+
+        // Check without waiting first, so stalls can be counted
+        if(glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+        {
+            _numberOfStalls++;
+
+            // The first wait flushes, so the fence is guaranteed to be signaled eventually
+            constexpr GLuint64 timeout = 1'000'000'000;
+
+            while(glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeout) == GL_TIMEOUT_EXPIRED);
+        };
+
+        glDeleteSync(fence);
+        fence = nullptr;
+    };
+
+
+public:
+
+    std::uint32_t GetBufferID() const
+    {
+        return _bufferId;
+    };
+
+    std::size_t GetRegionSizeInBytes() const
+    {
+        return _regionSizeInBytes;
+    };
+
+    std::uint32_t GetNumberOfRegions() const
+    {
+        return static_cast<std::uint32_t>(_regionFences.size());
+    };
+
+    std::uint64_t GetNumberOfStalls() const
+    {
+        return _numberOfStalls;
+    };
+
+
+public:
+
+    StreamingBuffer& operator = (const StreamingBuffer&) = delete;
+
+};
\ No newline at end of file
@@ -0,0 +1,358 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <algorithm>
+#include <iostream>
+#include <glad/glad.h>
+
+
+/// <summary>
+/// A GL_TEXTURE_2D_ARRAY of layers that are all the same size, either RGBA8 or a compressed format.
+/// Unlike an array of sampler2D, the layer is just a texture coordinate, so it can differ between invocations without breaking dynamic uniformity
+/// </summary>
+class TextureArray
+{
+
+private:
+
+    std::uint32_t _textureID = 0;
+
+    std::uint32_t _width = 0;
+    std::uint32_t _height = 0;
+
+    std::uint32_t _numberOfLayers = 0;
+
+    std::uint32_t _numberOfMipLevels = 0;
+
+    /// <summary>
+    /// GL_RGBA8, or a compressed format such as GL_COMPRESSED_RGBA_S3TC_DXT5_EXT (BC3)
+    /// </summary>
+    GLenum _internalFormat = GL_RGBA8;
+
+
+public:
+
+    /// <summary>
+    /// Allocate immutable storage for every layer and mip level. RGBA8 layers start out transparent, unless told otherwise. 
+    /// Compressed layers must be uploaded whole with SetLevel()
+    /// </summary>
+    /// <param name="width"></param>
+    /// <param name="height"></param>
+    /// <param name="numberOfLayers"></param>
+    /// <param name="internalFormat"></param>
+    /// <param name="numberOfMipLevels"> 0 for a full mip chain, down to 1x1 </param>
+    /// <param name="clearLayers"> False if every level will be uploaded whole with SetLevel(), so clearing them first is wasted work </param>
+    TextureArray(const std::uint32_t width, const std::uint32_t height, const std::uint32_t numberOfLayers, const GLenum internalFormat = GL_RGBA8, const std::uint32_t numberOfMipLevels = 0, const bool clearLayers = true) :
+        _width(width),
+        _height(height),
+        _numberOfLayers(numberOfLayers),
+        _numberOfMipLevels(numberOfMipLevels),
+        _internalFormat(internalFormat)
+    {
+        GLint maxLayers = 0;
+        glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+
+        if((numberOfLayers == 0) ||
+           (numberOfLayers > static_cast<std::uint32_t>(maxLayers)))
+        {
+            std::cerr << "Texture array error: " << numberOfLayers << " layers is out of range, the driver supports up to " << maxLayers << "\n";
+            __debugbreak();
+        };
+
+
+        if(_numberOfMipLevels == 0)
+            _numberOfMipLevels = GetFullMipChainLength(width, height);
+
+        glGenTextures(1, &_textureID);
+
+        glBindTexture(GL_TEXTURE_2D_ARRAY, _textureID);
+
+        glTexStorage3D(GL_TEXTURE_2D_ARRAY, _numberOfMipLevels, internalFormat, width, height, numberOfLayers);
+
+        // Layers hold unrelated images, so sampling must not wrap around into the other side of a layer
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+
+        // Compressed formats can't be cleared, and are always uploaded whole
+        if((IsCompressed() == true) ||
+           (clearLayers == false))
+            return;
+
+        // Immutable storage starts out undefined, parts of a layer an image doesn't cover must be transparent
+        const std::uint8_t transparent[4] = { 0, 0, 0, 0 };
+
+        for(std::uint32_t mipLevel = 0; mipLevel < _numberOfMipLevels; mipLevel++)
+            glClearTexImage(_textureID, mipLevel, GL_RGBA, GL_UNSIGNED_BYTE, transparent);
+    };
+
+
+    TextureArray(TextureArray&& other) noexcept :
+        _textureID(other._textureID),
+        _width(other._width),
+        _height(other._height),
+        _numberOfLayers(other._numberOfLayers),
+        _numberOfMipLevels(other._numberOfMipLevels),
+        _internalFormat(other._internalFormat)
+    {
+        other._textureID = 0;
+    };
+
+    TextureArray(const TextureArray&) = delete;
+
+
+    ~TextureArray()
+    {
+        if(_textureID != 0)
+            glDeleteTextures(1, &_textureID);
+    };
+
+
+public:
+
+    /// <summary>
+    /// Write RGBA8 pixels to a rectangle of a layer's top mip level, of an RGBA8 texture. GenerateMipmaps() must be called once every layer was written
+    /// </summary>
+    /// <param name="layer"></param>
+    /// <param name="x"></param>
+    /// <param name="y"></param>
+    /// <param name="width"></param>
+    /// <param name="height"></param>
+    /// <param name="pixels"> Tightly packed rows, bottom row first. Or, while a GL_PIXEL_UNPACK_BUFFER is bound, their offset inside it </param>
+    void SetLayer(const std::uint32_t layer, const std::uint32_t x, const std::uint32_t y, const std::uint32_t width, const std::uint32_t height, const std::uint8_t* pixels)
+    {
+        if(IsCompressed() == true)
+        {
+            std::cerr << "Texture array error: Compressed layers can only be uploaded whole, with SetLevel()\n";
+            __debugbreak();
+        };
+
+        if((layer >= _numberOfLayers) ||
+           ((x + width) > _width) ||
+           ((y + height) > _height))
+        {
+            std::cerr << "Texture array error: A " << width << "x" << height << " image at (" << x << ", " << y << ") of layer " << layer
+                << " doesn't fit in " << _numberOfLayers << " layers of " << _width << "x" << _height << "\n";
+            __debugbreak();
+        };
+
+        glBindTexture(GL_TEXTURE_2D_ARRAY, _textureID);
+
+        // Rows of RGBA8 pixels are always 4 byte aligned, but images from elsewhere may come with a different unpack alignment set
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, x, y, layer, width, height, 1, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    };
+
+
+    /// <summary>
+    /// Upload a whole mip level of every layer at once, in the texture's own format. 
+    /// Meant for data that was read back with GetLevel(), compressed data is uploaded as is
+    /// </summary>
+    /// <param name="mipLevel"></param>
+    /// <param name="data"> Every layer of the level, first layer first </param>
+    /// <param name="sizeInBytes"></param>
+    void SetLevel(const std::uint32_t mipLevel, const void* data, const std::size_t sizeInBytes)
+    {
+        glBindTexture(GL_TEXTURE_2D_ARRAY, _textureID);
+
+        if(IsCompressed() == true)
+        {
+            glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, mipLevel, 0, 0, 0, GetLevelWidth(mipLevel), GetLevelHeight(mipLevel), _numberOfLayers,
+                                      _internalFormat, static_cast<GLsizei>(sizeInBytes), data);
+        }
+        else
+        {
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+            glTexSubImage3D(GL_TEXTURE_2D_ARRAY, mipLevel, 0, 0, 0, GetLevelWidth(mipLevel), GetLevelHeight(mipLevel), _numberOfLayers, GL_RGBA, GL_UNSIGNED_BYTE, data);
+        };
+
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    };
+
+    /// <summary>
+    /// Read a whole mip level of every layer back, in the texture's own format. Waits for the GPU
+    /// </summary>
+    /// <param name="mipLevel"></param>
+    /// <returns></returns>
+    std::vector<std::uint8_t> GetLevel(const std::uint32_t mipLevel) const
+    {
+        glBindTexture(GL_TEXTURE_2D_ARRAY, _textureID);
+
+        std::vector<std::uint8_t> data;
+
+        if(IsCompressed() == true)
+        {
+            GLint sizeInBytes = 0;
+            glGetTexLevelParameteriv(GL_TEXTURE_2D_ARRAY, mipLevel, GL_TEXTURE_COMPRESSED_IMAGE_SIZE, &sizeInBytes);
+
+            data.resize(sizeInBytes);
+            glGetCompressedTexImage(GL_TEXTURE_2D_ARRAY, mipLevel, data.data());
+        }
+        else
+        {
+            data.resize(static_cast<std::size_t>(GetLevelWidth(mipLevel)) * GetLevelHeight(mipLevel) * _numberOfLayers * 4);
+
+            glPixelStorei(GL_PACK_ALIGNMENT, 4);
+            glGetTexImage(GL_TEXTURE_2D_ARRAY, mipLevel, GL_RGBA, GL_UNSIGNED_BYTE, data.data());
+        };
+
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+        return data;
+    };
+
+
+    /// <summary>
+    /// Build every layer's mip chain from its top mip level
+    /// </summary>
+    void GenerateMipmaps()
+    {
+        glBindTexture(GL_TEXTURE_2D_ARRAY, _textureID);
+
+        glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    };
+
+
+    /// <summary>
+    /// Build a single layer's mip chain from its top mip level, through a view of just that layer, so the other layers aren't touched
+    /// </summary>
+    /// <param name="layer"></param>
+    void GenerateLayerMipmaps(const std::uint32_t layer)
+    {
+        // A view needs a name that was never bound
+        std::uint32_t layerViewID = 0;
+        glGenTextures(1, &layerViewID);
+
+        glTextureView(layerViewID, GL_TEXTURE_2D_ARRAY, _textureID, _internalFormat, 0, _numberOfMipLevels, layer, 1);
+
+        glBindTexture(GL_TEXTURE_2D_ARRAY, layerViewID);
+
+        glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+        glDeleteTextures(1, &layerViewID);
+    };
+
+
+    void Bind(const std::uint32_t textureUnit = 0) const
+    {
+        glActiveTexture(GL_TEXTURE0 + textureUnit);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, _textureID);
+    };
+
+
+public:
+
+    std::uint32_t GetTextureID() const
+    {
+        return _textureID;
+    };
+
+    std::uint32_t GetWidth() const
+    {
+        return _width;
+    };
+
+    std::uint32_t GetHeight() const
+    {
+        return _height;
+    };
+
+    std::uint32_t GetNumberOfLayers() const
+    {
+        return _numberOfLayers;
+    };
+
+    std::uint32_t GetNumberOfMipLevels() const
+    {
+        return _numberOfMipLevels;
+    };
+
+    std::uint32_t GetLevelWidth(const std::uint32_t mipLevel) const
+    {
+        return std::max(_width >> mipLevel, 1u);
+    };
+
+    std::uint32_t GetLevelHeight(const std::uint32_t mipLevel) const
+    {
+        return std::max(_height >> mipLevel, 1u);
+    };
+
+    /// <summary>
+    /// The size of a whole mip level of every layer. 
+    /// Compressed formats are assumed to be 4x4 blocks of 16 bytes, like BC3
+    /// </summary>
+    /// <param name="mipLevel"></param>
+    /// <returns></returns>
+    std::size_t GetLevelSizeInBytes(const std::uint32_t mipLevel) const
+    {
+        const std::size_t width = GetLevelWidth(mipLevel);
+        const std::size_t height = GetLevelHeight(mipLevel);
+
+        if(IsCompressed() == true)
+            return ((width + 3) / 4) * ((height + 3) / 4) * 16 * _numberOfLayers;
+
+        return width * height * 4 * _numberOfLayers;
+    };
+
+    /// <summary>
+    /// The texture memory of every layer and mip level
+    /// </summary>
+    /// <returns></returns>
+    std::size_t GetSizeInBytes() const
+    {
+        std::size_t sizeInBytes = 0;
+
+        for(std::uint32_t mipLevel = 0; mipLevel < _numberOfMipLevels; mipLevel++)
+            sizeInBytes += GetLevelSizeInBytes(mipLevel);
+
+        return sizeInBytes;
+    };
+
+    GLenum GetInternalFormat() const
+    {
+        return _internalFormat;
+    };
+
+    bool IsCompressed() const
+    {
+        return _internalFormat != GL_RGBA8;
+    };
+
+
+    /// <summary>
+    /// The number of levels in a full mip chain, down to 1x1
+    /// </summary>
+    /// <param name="width"></param>
+    /// <param name="height"></param>
+    /// <returns></returns>
+    static std::uint32_t GetFullMipChainLength(const std::uint32_t width, const std::uint32_t height)
+    {
+        std::uint32_t numberOfMipLevels = 0;
+
+        for(std::uint32_t size = std::max(width, height); size > 0; size >>= 1)
+            numberOfMipLevels++;
+
+        return numberOfMipLevels;
+    };
+
+
+public:
+
+    TextureArray& operator = (const TextureArray&) = delete;
+
+};
\ No newline at end of file
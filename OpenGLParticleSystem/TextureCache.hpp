@@ -0,0 +1,606 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <array>
+#include <optional>
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+#include <iostream>
+#include <glad/glad.h>
+#include <glm/vec4.hpp>
+
+#include "MappedFile.hpp"
+#include "TextureArray.hpp"
+#include "SpriteSheet.hpp"
+
+
+// Part of EXT_texture_compression_s3tc, which every desktop driver exposes, but the loader wasn't generated with
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+    #define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
+
+/// <summary>
+/// A cache of cooked sprite sheets.
+/// Cooking decodes, packs and mipmaps the sprites once, optionally compresses them to BC3 (DXT5), and writes every mip level to a file as the GPU wants it.
+/// Loading maps the file and uploads the levels straight out of it, without decoding or generating anything,
+/// as long as the cache was cooked from the same sprites. Otherwise the sprites are decoded like before
+/// </summary>
+class TextureCache
+{
+
+private:
+
+    /// <summary>
+    /// "PSTC", Particle Sprite Texture Cache
+    /// </summary>
+    static constexpr std::uint32_t Magic = 0x43545350;
+
+    /// <summary>
+    /// Bumped whenever the file layout, or the way sprites are packed, changes, so old caches are treated as stale
+    /// </summary>
+    static constexpr std::uint32_t Version = 2;
+
+    /// <summary>
+    /// Offsets of level data are aligned to this, so uploads read from aligned addresses
+    /// </summary>
+    static constexpr std::uint64_t LevelAlignment = 16;
+
+
+    /// <summary>
+    /// The start of a cache file.
+    /// Followed by a SourceStamp and a UV rect per layer, a LevelEntry per mip level, and the data of every level
+    /// </summary>
+    struct FileHeader
+    {
+        std::uint32_t Magic = 0;
+        std::uint32_t Version = 0;
+
+        /// <summary>
+        /// HashSources() of the sprites the cache was cooked from
+        /// </summary>
+        std::uint64_t SourceHash = 0;
+
+        std::uint32_t LayerWidth = 0;
+        std::uint32_t LayerHeight = 0;
+        std::uint32_t NumberOfLayers = 0;
+        std::uint32_t NumberOfMipLevels = 0;
+
+        /// <summary>
+        /// GL_RGBA8 or GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+        /// </summary>
+        std::uint32_t InternalFormat = 0;
+
+        std::uint32_t Padding = 0;
+    };
+
+    static_assert(sizeof(FileHeader) == 40, "The cache file layout must not depend on the compiler");
+
+
+    /// <summary>
+    /// What a sprite's file looked like when the cache was cooked.
+    /// If every sprite still matches its stamp the cache is fresh, and the sprites' contents are never read
+    /// </summary>
+    struct SourceStamp
+    {
+        /// <summary>
+        /// A hash of the file's name, without its directory
+        /// </summary>
+        std::uint64_t NameHash = 0;
+
+        std::uint64_t SizeInBytes = 0;
+
+        std::int64_t ModificationTime = 0;
+
+        bool operator == (const SourceStamp&) const = default;
+    };
+
+    static_assert(sizeof(SourceStamp) == 24, "The cache file layout must not depend on the compiler");
+
+
+    /// <summary>
+    /// Where a mip level's data, of every layer, is inside the file
+    /// </summary>
+    struct LevelEntry
+    {
+        std::uint64_t Offset = 0;
+        std::uint64_t SizeInBytes = 0;
+    };
+
+    static_assert(sizeof(LevelEntry) == 16, "The cache file layout must not depend on the compiler");
+
+
+public:
+
+    /// <summary>
+    /// Cook sprites into a cache file. Needs a GL context, the GPU packs and mipmaps the sprites
+    /// </summary>
+    /// <param name="spritePaths"> The sprites, in layer order </param>
+    /// <param name="cachePath"></param>
+    /// <param name="compress"> Compress to BC3, on the CPU. If the driver can't sample BC3 the cache is written uncompressed </param>
+    /// <returns> If the cache file was written </returns>
+    static bool Cook(const std::vector<std::string>& spritePaths, const std::string& cachePath, const bool compress)
+    {
+        const SpriteSheet sprites = SpriteSheet::PackFiles(spritePaths);
+
+        const TextureArray& textureArray = sprites.GetTextureArray();
+
+
+        FileHeader header =
+        {
+            .Magic = Magic,
+            .Version = Version,
+            .SourceHash = HashSources(spritePaths),
+            .LayerWidth = textureArray.GetWidth(),
+            .LayerHeight = textureArray.GetHeight(),
+            .NumberOfLayers = textureArray.GetNumberOfLayers(),
+            .NumberOfMipLevels = textureArray.GetNumberOfMipLevels(),
+            .InternalFormat = GL_RGBA8,
+        };
+
+        const std::vector<SourceStamp> sourceStamps = GetSourceStamps(spritePaths);
+
+
+        if(compress == true)
+        {
+            if(IsFormatSupported(GL_COMPRESSED_RGBA_S3TC_DXT5_EXT) == true)
+                header.InternalFormat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+            else
+                std::cerr << "Texture cache warning: The driver doesn't support BC3, the cache is written uncompressed\n";
+        };
+
+
+        std::vector<std::vector<std::uint8_t>> levels;
+        levels.reserve(header.NumberOfMipLevels);
+
+        for(std::uint32_t mipLevel = 0; mipLevel < header.NumberOfMipLevels; mipLevel++)
+        {
+            std::vector<std::uint8_t> level = textureArray.GetLevel(mipLevel);
+
+            if(header.InternalFormat == GL_COMPRESSED_RGBA_S3TC_DXT5_EXT)
+                level = CompressLevelBC3(level, textureArray.GetLevelWidth(mipLevel), textureArray.GetLevelHeight(mipLevel), header.NumberOfLayers);
+
+            levels.push_back(std::move(level));
+        };
+
+
+        std::vector<LevelEntry> levelEntries(header.NumberOfMipLevels);
+
+        std::uint64_t offset = sizeof(FileHeader) + ((sizeof(SourceStamp) + sizeof(glm::vec4)) * header.NumberOfLayers) + (sizeof(LevelEntry) * header.NumberOfMipLevels);
+
+        for(std::uint32_t mipLevel = 0; mipLevel < header.NumberOfMipLevels; mipLevel++)
+        {
+            offset = AlignUp(offset);
+
+            levelEntries[mipLevel] = { offset, levels[mipLevel].size() };
+
+            offset += levels[mipLevel].size();
+        };
+
+
+        // Written to a temporary file first, so a failed cook never leaves a truncated cache behind
+        const std::string temporaryPath = cachePath + ".tmp";
+
+        std::ofstream file = std::ofstream(temporaryPath, std::ios::binary | std::ios::trunc);
+
+        if(file.is_open() == false)
+        {
+            std::cerr << "Texture cache error: Unable to create \"" << temporaryPath << "\"\n";
+            return false;
+        };
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(FileHeader));
+        file.write(reinterpret_cast<const char*>(sourceStamps.data()), sizeof(SourceStamp) * header.NumberOfLayers);
+        file.write(reinterpret_cast<const char*>(sprites.GetUVRects().data()), sizeof(glm::vec4) * header.NumberOfLayers);
+        file.write(reinterpret_cast<const char*>(levelEntries.data()), sizeof(LevelEntry) * header.NumberOfMipLevels);
+
+        for(std::uint32_t mipLevel = 0; mipLevel < header.NumberOfMipLevels; mipLevel++)
+        {
+            const char padding[LevelAlignment] = { };
+
+            file.write(padding, levelEntries[mipLevel].Offset - static_cast<std::uint64_t>(file.tellp()));
+            file.write(reinterpret_cast<const char*>(levels[mipLevel].data()), levels[mipLevel].size());
+        };
+
+        file.close();
+
+        if(file.fail() == true)
+        {
+            std::cerr << "Texture cache error: Unable to write \"" << temporaryPath << "\"\n";
+            return false;
+        };
+
+
+        std::error_code error;
+        std::filesystem::rename(temporaryPath, cachePath, error);
+
+        if(error)
+        {
+            std::cerr << "Texture cache error: Unable to replace \"" << cachePath << "\", \"" << error.message() << "\"\n";
+            return false;
+        };
+
+        std::cout << "Texture cache: Wrote " << header.NumberOfLayers << " layers of " << header.LayerWidth << "x" << header.LayerHeight << ", " << header.NumberOfMipLevels << " mip levels, as "
+            << ((header.InternalFormat == GL_RGBA8) ? "RGBA8" : "BC3") << " (" << offset / 1024.0f << " KB)\n";
+
+        return true;
+    };
+
+
+    /// <summary>
+    /// Load a sprite sheet from a cache file.
+    /// The cache is stale if it's missing, damaged, from a different version, or wasn't cooked from exactly these sprites.
+    /// Sprites are only hashed if their size or modification time changed since the cook
+    /// </summary>
+    /// <param name="spritePaths"> The sprites, in layer order </param>
+    /// <param name="cachePath"></param>
+    /// <returns> The sprite sheet, or nothing if the cache is stale </returns>
+    static std::optional<SpriteSheet> Load(const std::vector<std::string>& spritePaths, const std::string& cachePath)
+    {
+        const MappedFile file = MappedFile(cachePath);
+
+        if((file.IsOpen() == false) ||
+           (file.GetSizeInBytes() < sizeof(FileHeader)))
+            return std::nullopt;
+
+
+        FileHeader header;
+        std::memcpy(&header, file.GetData(), sizeof(FileHeader));
+
+        GLint maxTextureSize = 0;
+        glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+
+        // The header sizes the texture's storage, a damaged one must not reach the driver either
+        if((header.Magic != Magic) ||
+           (header.Version != Version) ||
+           (header.NumberOfLayers != spritePaths.size()) ||
+           (header.LayerWidth == 0) ||
+           (header.LayerHeight == 0) ||
+           (header.LayerWidth > static_cast<std::uint32_t>(maxTextureSize)) ||
+           (header.LayerHeight > static_cast<std::uint32_t>(maxTextureSize)) ||
+           (header.NumberOfMipLevels == 0) ||
+           (header.NumberOfMipLevels > TextureArray::GetFullMipChainLength(header.LayerWidth, header.LayerHeight)) ||
+           ((header.InternalFormat != GL_RGBA8) && (header.InternalFormat != GL_COMPRESSED_RGBA_S3TC_DXT5_EXT)) ||
+           (IsFormatSupported(header.InternalFormat) == false))
+            return std::nullopt;
+
+
+        const std::size_t sourceStampsOffset = sizeof(FileHeader);
+        const std::size_t uvRectsOffset = sourceStampsOffset + (sizeof(SourceStamp) * header.NumberOfLayers);
+        const std::size_t levelEntriesOffset = uvRectsOffset + (sizeof(glm::vec4) * header.NumberOfLayers);
+
+        if((levelEntriesOffset + (sizeof(LevelEntry) * header.NumberOfMipLevels)) > file.GetSizeInBytes())
+            return std::nullopt;
+
+        std::vector<SourceStamp> sourceStamps(header.NumberOfLayers);
+        std::memcpy(sourceStamps.data(), file.GetData() + sourceStampsOffset, sizeof(SourceStamp) * header.NumberOfLayers);
+
+        // Touched, but unchanged, sprites still match the hash. The cache stays valid, it just takes the slow check until it's cooked again
+        if((sourceStamps != GetSourceStamps(spritePaths)) &&
+           (header.SourceHash != HashSources(spritePaths)))
+            return std::nullopt;
+
+        std::vector<glm::vec4> uvRects(header.NumberOfLayers);
+        std::memcpy(uvRects.data(), file.GetData() + uvRectsOffset, sizeof(glm::vec4) * header.NumberOfLayers);
+
+        std::vector<LevelEntry> levelEntries(header.NumberOfMipLevels);
+        std::memcpy(levelEntries.data(), file.GetData() + levelEntriesOffset, sizeof(LevelEntry) * header.NumberOfMipLevels);
+
+
+        // Every level is uploaded whole right after, there's nothing to clear
+        TextureArray textureArray = TextureArray(header.LayerWidth, header.LayerHeight, header.NumberOfLayers, header.InternalFormat, header.NumberOfMipLevels, false);
+
+        // Validate every level before uploading any of them, a damaged cache must not reach the driver
+        for(std::uint32_t mipLevel = 0; mipLevel < header.NumberOfMipLevels; mipLevel++)
+        {
+            const LevelEntry& levelEntry = levelEntries[mipLevel];
+
+            if((levelEntry.SizeInBytes != textureArray.GetLevelSizeInBytes(mipLevel)) ||
+               (levelEntry.Offset > file.GetSizeInBytes()) ||
+               (levelEntry.SizeInBytes > (file.GetSizeInBytes() - levelEntry.Offset)))
+                return std::nullopt;
+        };
+
+        for(std::uint32_t mipLevel = 0; mipLevel < header.NumberOfMipLevels; mipLevel++)
+            textureArray.SetLevel(mipLevel, file.GetData() + levelEntries[mipLevel].Offset, levelEntries[mipLevel].SizeInBytes);
+
+
+        return SpriteSheet(std::move(textureArray), std::move(uvRects));
+    };
+
+
+    /// <summary>
+    /// A 64 bit FNV-1a hash of the sprites' file names and contents.
+    /// Names are hashed without their directory, so moving the sprites and the cache together doesn't invalidate it
+    /// </summary>
+    /// <param name="spritePaths"></param>
+    /// <returns></returns>
+    static std::uint64_t HashSources(const std::vector<std::string>& spritePaths)
+    {
+        std::uint64_t hash = FnvOffsetBasis;
+
+        for(const std::string& spritePath : spritePaths)
+        {
+            const std::string fileName = std::filesystem::path(spritePath).filename().string();
+
+            // Hashed with their sizes, so ("ab", "c") and ("a", "bc") don't collide
+            const std::uint64_t fileNameSize = fileName.size();
+
+            hash = HashBytes(hash, &fileNameSize, sizeof(fileNameSize));
+            hash = HashBytes(hash, fileName.data(), fileName.size());
+
+
+            const MappedFile file = MappedFile(spritePath);
+
+            const std::uint64_t fileSize = file.GetSizeInBytes();
+
+            hash = HashBytes(hash, &fileSize, sizeof(fileSize));
+            hash = HashBytes(hash, file.GetData(), file.GetSizeInBytes());
+        };
+
+        return hash;
+    };
+
+
+private:
+
+    static constexpr std::uint64_t FnvOffsetBasis = 0xCBF29CE484222325;
+    static constexpr std::uint64_t FnvPrime = 0x100000001B3;
+
+
+    /// <summary>
+    /// Continue a 64 bit FNV-1a hash with more bytes
+    /// </summary>
+    /// <param name="hash"></param>
+    /// <param name="data"></param>
+    /// <param name="sizeInBytes"></param>
+    /// <returns></returns>
+    static std::uint64_t HashBytes(std::uint64_t hash, const void* data, const std::size_t sizeInBytes)
+    {
+        const std::uint8_t* bytes = static_cast<const std::uint8_t*>(data);
+
+        for(std::size_t i = 0; i < sizeInBytes; i++)
+        {
+            hash ^= bytes[i];
+            hash *= FnvPrime;
+        };
+
+        return hash;
+    };
+
+
+    /// <summary>
+    /// The name, size, and modification time of every sprite. Only reads the file system's metadata
+    /// </summary>
+    /// <param name="spritePaths"></param>
+    /// <returns></returns>
+    static std::vector<SourceStamp> GetSourceStamps(const std::vector<std::string>& spritePaths)
+    {
+        std::vector<SourceStamp> sourceStamps;
+        sourceStamps.reserve(spritePaths.size());
+
+        for(const std::string& spritePath : spritePaths)
+        {
+            const std::string fileName = std::filesystem::path(spritePath).filename().string();
+
+            // A missing sprite gets an empty stamp, which never matches a cooked one
+            std::error_code error;
+
+            const std::uintmax_t sizeInBytes = std::filesystem::file_size(spritePath, error);
+            const std::filesystem::file_time_type modificationTime = std::filesystem::last_write_time(spritePath, error);
+
+            sourceStamps.push_back(
+            {
+                .NameHash = HashBytes(FnvOffsetBasis, fileName.data(), fileName.size()),
+                .SizeInBytes = error ? 0 : static_cast<std::uint64_t>(sizeInBytes),
+                .ModificationTime = error ? 0 : static_cast<std::int64_t>(modificationTime.time_since_epoch().count()),
+            });
+        };
+
+        return sourceStamps;
+    };
+
+
+    /// <summary>
+    /// If the driver can create textures of a format
+    /// </summary>
+    /// <param name="internalFormat"></param>
+    /// <returns></returns>
+    static bool IsFormatSupported(const GLenum internalFormat)
+    {
+        GLint supported = GL_FALSE;
+        glGetInternalformativ(GL_TEXTURE_2D_ARRAY, internalFormat, GL_INTERNALFORMAT_SUPPORTED, 1, &supported);
+
+        return supported == GL_TRUE;
+    };
+
+
+    /// <summary>
+    /// Compress a level of RGBA8 layers to BC3: 4x4 blocks of 16 bytes, an interpolated alpha block followed by an interpolated colour block.
+    /// Endpoints are the block's bounding box, which is fast and good enough for soft particle sprites.
+    /// Blocks past the edge of levels smaller than 4x4 repeat the edge pixels
+    /// </summary>
+    /// <param name="pixels"> Every layer of the level, first layer first </param>
+    /// <param name="width"></param>
+    /// <param name="height"></param>
+    /// <param name="numberOfLayers"></param>
+    /// <returns></returns>
+    static std::vector<std::uint8_t> CompressLevelBC3(const std::vector<std::uint8_t>& pixels, const std::uint32_t width, const std::uint32_t height, const std::uint32_t numberOfLayers)
+    {
+        const std::uint32_t blocksX = (width + 3) / 4;
+        const std::uint32_t blocksY = (height + 3) / 4;
+
+        std::vector<std::uint8_t> blocks(static_cast<std::size_t>(blocksX) * blocksY * numberOfLayers * 16);
+
+        std::uint8_t* block = blocks.data();
+
+        for(std::uint32_t layer = 0; layer < numberOfLayers; layer++)
+        {
+            const std::uint8_t* layerPixels = pixels.data() + (static_cast<std::size_t>(width) * height * 4 * layer);
+
+            for(std::uint32_t blockY = 0; blockY < blocksY; blockY++)
+            {
+                for(std::uint32_t blockX = 0; blockX < blocksX; blockX++)
+                {
+                    std::array<std::array<std::uint8_t, 4>, 16> blockPixels;
+
+                    for(std::uint32_t i = 0; i < 16; i++)
+                    {
+                        const std::uint32_t x = std::min((blockX * 4) + (i % 4), width - 1);
+                        const std::uint32_t y = std::min((blockY * 4) + (i / 4), height - 1);
+
+                        std::memcpy(blockPixels[i].data(), layerPixels + ((static_cast<std::size_t>(y) * width) + x) * 4, 4);
+                    };
+
+                    EncodeBC3Block(blockPixels, block);
+
+                    block += 16;
+                };
+            };
+        };
+
+        return blocks;
+    };
+
+    static void EncodeBC3Block(const std::array<std::array<std::uint8_t, 4>, 16>& blockPixels, std::uint8_t* block)
+    {
+        // Alpha: 2 endpoints and a 3 bit index per pixel, 6 interpolated values between the endpoints when the first is larger
+        std::uint8_t maxAlpha = 0;
+        std::uint8_t minAlpha = 255;
+
+        for(const std::array<std::uint8_t, 4>& pixel : blockPixels)
+        {
+            maxAlpha = std::max(maxAlpha, pixel[3]);
+            minAlpha = std::min(minAlpha, pixel[3]);
+        };
+
+        block[0] = maxAlpha;
+        block[1] = minAlpha;
+
+        std::array<std::uint32_t, 8> alphaPalette = { maxAlpha, minAlpha };
+
+        for(std::uint32_t i = 1; i < 7; i++)
+            alphaPalette[i + 1] = (((7 - i) * maxAlpha) + (i * minAlpha) + 3) / 7;
+
+        std::uint64_t alphaIndices = 0;
+
+        for(std::uint32_t i = 0; i < 16; i++)
+        {
+            // Equal endpoints leave every index at 0
+            if(maxAlpha == minAlpha)
+                break;
+
+            alphaIndices |= static_cast<std::uint64_t>(FindClosest(alphaPalette, blockPixels[i][3])) << (3 * i);
+        };
+
+        for(std::uint32_t i = 0; i < 6; i++)
+            block[2 + i] = static_cast<std::uint8_t>(alphaIndices >> (8 * i));
+
+
+        // Colour: 2 RGB565 endpoints and a 2 bit index per pixel. In BC3 the colour block always interpolates 2 values between the endpoints
+        std::array<std::uint8_t, 3> maxColour = { 0, 0, 0 };
+        std::array<std::uint8_t, 3> minColour = { 255, 255, 255 };
+
+        for(const std::array<std::uint8_t, 4>& pixel : blockPixels)
+        {
+            for(std::uint32_t channel = 0; channel < 3; channel++)
+            {
+                maxColour[channel] = std::max(maxColour[channel], pixel[channel]);
+                minColour[channel] = std::min(minColour[channel], pixel[channel]);
+            };
+        };
+
+        const std::uint16_t colour0 = ToRGB565(maxColour);
+        const std::uint16_t colour1 = ToRGB565(minColour);
+
+        const std::array<std::int32_t, 3> endpoint0 = FromRGB565(colour0);
+        const std::array<std::int32_t, 3> endpoint1 = FromRGB565(colour1);
+
+        std::array<std::array<std::int32_t, 3>, 4> colourPalette = { endpoint0, endpoint1 };
+
+        for(std::uint32_t channel = 0; channel < 3; channel++)
+        {
+            colourPalette[2][channel] = ((2 * endpoint0[channel]) + endpoint1[channel]) / 3;
+            colourPalette[3][channel] = (endpoint0[channel] + (2 * endpoint1[channel])) / 3;
+        };
+
+        std::uint32_t colourIndices = 0;
+
+        for(std::uint32_t i = 0; i < 16; i++)
+        {
+            std::uint32_t closestIndex = 0;
+            std::int32_t closestDistance = INT32_MAX;
+
+            for(std::uint32_t paletteIndex = 0; paletteIndex < 4; paletteIndex++)
+            {
+                std::int32_t distance = 0;
+
+                for(std::uint32_t channel = 0; channel < 3; channel++)
+                {
+                    const std::int32_t difference = colourPalette[paletteIndex][channel] - blockPixels[i][channel];
+
+                    distance += difference * difference;
+                };
+
+                if(distance < closestDistance)
+                {
+                    closestDistance = distance;
+                    closestIndex = paletteIndex;
+                };
+            };
+
+            colourIndices |= closestIndex << (2 * i);
+        };
+
+        block[8] = static_cast<std::uint8_t>(colour0);
+        block[9] = static_cast<std::uint8_t>(colour0 >> 8);
+        block[10] = static_cast<std::uint8_t>(colour1);
+        block[11] = static_cast<std::uint8_t>(colour1 >> 8);
+
+        for(std::uint32_t i = 0; i < 4; i++)
+            block[12 + i] = static_cast<std::uint8_t>(colourIndices >> (8 * i));
+    };
+
+    static std::uint32_t FindClosest(const std::array<std::uint32_t, 8>& palette, const std::uint32_t value)
+    {
+        std::uint32_t closestIndex = 0;
+
+        for(std::uint32_t i = 1; i < palette.size(); i++)
+        {
+            if(std::abs(static_cast<std::int32_t>(palette[i]) - static_cast<std::int32_t>(value)) < std::abs(static_cast<std::int32_t>(palette[closestIndex]) - static_cast<std::int32_t>(value)))
+                closestIndex = i;
+        };
+
+        return closestIndex;
+    };
+
+    static std::uint16_t ToRGB565(const std::array<std::uint8_t, 3>& colour)
+    {
+        return static_cast<std::uint16_t>((((colour[0] * 31) + 127) / 255) << 11) |
+               static_cast<std::uint16_t>((((colour[1] * 63) + 127) / 255) << 5) |
+               static_cast<std::uint16_t>(((colour[2] * 31) + 127) / 255);
+    };
+
+    static std::array<std::int32_t, 3> FromRGB565(const std::uint16_t colour)
+    {
+        const std::int32_t red = (colour >> 11) & 31;
+        const std::int32_t green = (colour >> 5) & 63;
+        const std::int32_t blue = colour & 31;
+
+        // Bit replication, the same expansion the GPU uses
+        return { (red << 3) | (red >> 2), (green << 2) | (green >> 4), (blue << 3) | (blue >> 2) };
+    };
+
+
+    static std::uint64_t AlignUp(const std::uint64_t offset)
+    {
+        return (offset + (LevelAlignment - 1)) & ~(LevelAlignment - 1);
+    };
+
+};
\ No newline at end of file
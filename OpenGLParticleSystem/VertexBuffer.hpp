@@ -67,8 +67,9 @@ public:
     std::unique_ptr<T, std::function<void(T*)>> MapBuffer(const GL::AccessType accessType = GL::AccessType::ReadWrite) const
     {
         // The deleter function used by the unique_ptr to release the acquired memory.
-        // Can't get the unique_ptr deleter to behave with anything other than a lambda and an 'std::function'
-        static auto deleter = [this](T* buffer)
+        // Can't get the unique_ptr deleter to behave with anything other than a lambda and an 'std::function'.
+        // Not static, a static deleter would keep the first buffer's 'this' and unmap that buffer instead
+        auto deleter = [this](T* buffer)
         {
             // Make sure that the correct buffer is bound before we unmap
             Bind();